@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "entities/components.hpp"
+#include "entities/registry.hpp"
+#include "entities/systems.hpp"
+#include "jobs.hpp"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace TSC;
+using namespace std;
+
+/* Fills `registry` with `count` moving entities, every fourth of which
+ * also falls down. Some entities are destroyed again so that the pools
+ * are not in creation order, as in a level where objects come and go. */
+static void populate(Registry& registry, int count)
+{
+    vector<Entity> entities;
+    for (int i=0; i < count + count / 10; i++) {
+        Entity entity = registry.Create();
+        registry.Add(entity, Position{sf::Vector2f(i * 32.0f, 0.0f)});
+        registry.Add(entity, Velocity{sf::Vector2f(100.0f, 0.0f)});
+        if (i % 4 == 0)
+            registry.Add(entity, Gravity{900.0f, 1000.0f});
+
+        entities.push_back(entity);
+    }
+
+    for (int i=0; i < count / 10; i++)
+        registry.Destroy(entities[i * 11]);
+}
+
+// One frame of the systems run by Level::Update() for state.range(0) entities.
+static void BM_EntitiesUpdate(benchmark::State& state)
+{
+    Registry registry;
+    populate(registry, static_cast<int>(state.range(0)));
+
+    for (auto _: state) {
+        Systems::ApplyGravity(registry, 1.0f / 60.0f);
+        Systems::Move(registry, 1.0f / 60.0f);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * registry.GetEntityCount());
+}
+BENCHMARK(BM_EntitiesUpdate)->Arg(1000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// BM_EntitiesUpdate with the job system in single-thread mode, for comparison.
+static void BM_EntitiesUpdateSingleThread(benchmark::State& state)
+{
+    Jobs::Init(0);
+    BM_EntitiesUpdate(state);
+    Jobs::Init(-1);
+}
+BENCHMARK(BM_EntitiesUpdateSingleThread)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// Creating and destroying entities with components, e.g. for projectiles.
+static void BM_EntitiesCreateDestroy(benchmark::State& state)
+{
+    Registry registry;
+    populate(registry, 100000);
+
+    for (auto _: state) {
+        Entity entity = registry.Create();
+        registry.Add(entity, Position{sf::Vector2f(0.0f, 0.0f)});
+        registry.Add(entity, Velocity{sf::Vector2f(0.0f, 0.0f)});
+        registry.Destroy(entity);
+    }
+}
+BENCHMARK(BM_EntitiesCreateDestroy);
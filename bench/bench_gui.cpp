@@ -0,0 +1,55 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "gui.hpp"
+#include "draw_list.hpp"
+#include <benchmark/benchmark.h>
+#include <SFML/Graphics.hpp>
+
+using namespace TSC;
+
+/* Translation of nuklear's drawing commands into SFML draw calls for
+ * a menu similar to the title menu, including drawing the resulting
+ * draw list. The window is rebuilt every iteration, as GUI::Draw()
+ * consumes the command queue. */
+static void BM_GUIDraw(benchmark::State& state)
+{
+    sf::RenderTexture target;
+    target.create(1024, 576);
+    nk_context* p_ctx = GUI::Get();
+    DrawList list;
+
+    for (auto _: state) {
+        if (nk_begin(p_ctx, "Benchmark", nk_rect(100, 100, 300, 400), NK_WINDOW_BORDER|NK_WINDOW_TITLE)) {
+            nk_layout_row_dynamic(p_ctx, 30, 1);
+            for (int i=0; i < state.range(0); i++) {
+                nk_label(p_ctx, "Label", NK_TEXT_LEFT);
+                nk_button_label(p_ctx, "Button");
+            }
+        }
+        nk_end(p_ctx);
+
+        list.Clear(target.getDefaultView());
+        GUI::Draw(list);
+        list.Sort();
+        list.Execute(target);
+    }
+}
+BENCHMARK(BM_GUIDraw)->Arg(4)->Arg(32);
@@ -0,0 +1,103 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "draw_list.hpp"
+#include <benchmark/benchmark.h>
+#include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
+#include <vector>
+
+using namespace TSC;
+using namespace std;
+
+/* Both ways of letterboxing a 1920x1080 stage on a 1920x1200 screen
+ * in fullscreen mode, as done by Application::Present(). A render
+ * texture stands in for the window. The frame consists of 2000
+ * coloured quads covering the stage a few times over, and each
+ * iteration waits for the GPU, as the difference is mostly fill rate. */
+
+static const unsigned int SCREEN_WIDTH  = 1920;
+static const unsigned int SCREEN_HEIGHT = 1200;
+static const unsigned int STAGE_WIDTH   = 1920;
+static const unsigned int STAGE_HEIGHT  = 1080;
+
+static void record_frame(DrawList& list)
+{
+    vector<sf::Vertex> quads;
+    for (int i=0; i < 2000; i++) {
+        float x = static_cast<float>((i * 97) % STAGE_WIDTH);
+        float y = static_cast<float>((i * 61) % STAGE_HEIGHT);
+        sf::Color color(i % 256, (i * 7) % 256, (i * 13) % 256, 128);
+
+        quads.push_back(sf::Vertex(sf::Vector2f(x,          y),          color));
+        quads.push_back(sf::Vertex(sf::Vector2f(x + 200.0f, y),          color));
+        quads.push_back(sf::Vertex(sf::Vector2f(x + 200.0f, y + 200.0f), color));
+        quads.push_back(sf::Vertex(sf::Vector2f(x,          y + 200.0f), color));
+    }
+
+    list.Clear(sf::View(sf::FloatRect(0, 0, STAGE_WIDTH, STAGE_HEIGHT)));
+    list.AddVertices(quads.data(), quads.size(), sf::Quads);
+    list.Sort();
+}
+
+// Drawing straight onto the screen with a viewport leaving the black bars.
+static void BM_LetterboxViewport(benchmark::State& state)
+{
+    sf::RenderTexture screen;
+    screen.create(SCREEN_WIDTH, SCREEN_HEIGHT);
+    DrawList list;
+    record_frame(list);
+
+    float top = (SCREEN_HEIGHT - STAGE_HEIGHT) / 2.0f;
+    sf::FloatRect viewport(0.0f, top / SCREEN_HEIGHT, 1.0f, static_cast<float>(STAGE_HEIGHT) / SCREEN_HEIGHT);
+
+    for (auto _: state) {
+        screen.clear(sf::Color::Black);
+        list.Execute(screen, viewport);
+        screen.display();
+        glFinish();
+    }
+}
+BENCHMARK(BM_LetterboxViewport)->Unit(benchmark::kMillisecond);
+
+// Drawing into a stage-sized texture first, which is then blitted.
+static void BM_LetterboxIntermediate(benchmark::State& state)
+{
+    sf::RenderTexture screen;
+    screen.create(SCREEN_WIDTH, SCREEN_HEIGHT);
+    sf::RenderTexture intermediate;
+    intermediate.create(STAGE_WIDTH, STAGE_HEIGHT);
+    sf::Sprite sprite(intermediate.getTexture());
+    sprite.setPosition(0.0f, (SCREEN_HEIGHT - STAGE_HEIGHT) / 2.0f);
+    DrawList list;
+    record_frame(list);
+
+    for (auto _: state) {
+        intermediate.clear(sf::Color::Black);
+        list.Execute(intermediate);
+        intermediate.display();
+
+        screen.clear(sf::Color::Black);
+        screen.draw(sprite);
+        screen.display();
+        glFinish();
+    }
+}
+BENCHMARK(BM_LetterboxIntermediate)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "level.hpp"
+#include "ground.hpp"
+#include "settings.hpp"
+#include "texture_cache.hpp"
+#include <benchmark/benchmark.h>
+#include <SFML/Graphics.hpp>
+#include <cmath>
+#include <vector>
+
+using namespace TSC;
+using namespace std;
+
+// Parsing a complete level, including the setup of its grounds.
+static void BM_LevelLoader(benchmark::State& state)
+{
+    for (auto _: state) {
+        Level level("test_level.tsc3lvl");
+        benchmark::DoNotOptimize(&level);
+    }
+}
+BENCHMARK(BM_LevelLoader)->Unit(benchmark::kMillisecond);
+
+// Texture lookup for a texture that is already in the cache.
+static void BM_TextureCacheGet(benchmark::State& state)
+{
+    TextureCache::Get("tilesets/green_3.png");
+
+    for (auto _: state)
+        benchmark::DoNotOptimize(&TextureCache::Get("tilesets/green_3.png"));
+}
+BENCHMARK(BM_TextureCacheGet);
+
+// Fields of a square ground of `edge`² fields with a pattern of tiles.
+static vector<Field> make_square_ground(int edge)
+{
+    vector<Field> fields;
+    fields.reserve(edge * edge);
+    for (int y=0; y < edge; y++)
+        for (int x=0; x < edge; x++)
+            fields.emplace_back(x * 64.0f, y * 64.0f, (x + y) % 15);
+
+    return fields;
+}
+
+/* Chunking and vertex array construction for a square ground of
+ * state.range(0)² fields, one chunk after another. The tilemap shader
+ * is disabled, as it would replace the vertices of dense chunks. */
+static void BM_GroundBuildChunks(benchmark::State& state)
+{
+    vector<Field> fields = make_square_ground(static_cast<int>(state.range(0)));
+    Ground ground("green_3.png", fields);
+    Settings::enable_shader_tilemap = false;
+
+    for (auto _: state) {
+        ground.SetFields(fields);
+        for (size_t i=0; i < ground.GetChunkCount(); i++)
+            ground.BuildChunk(i);
+    }
+
+    state.SetItemsProcessed(state.iterations() * fields.size());
+}
+BENCHMARK(BM_GroundBuildChunks)->Arg(16)->Arg(128)->Arg(1024)->Unit(benchmark::kMillisecond);
+
+// Same as above, but building all chunks on all cores at once.
+static void BM_GroundBuildChunksParallel(benchmark::State& state)
+{
+    vector<Field> fields = make_square_ground(static_cast<int>(state.range(0)));
+    Ground ground("green_3.png", fields);
+    Settings::enable_shader_tilemap = false;
+
+    vector<size_t> indices;
+    for (auto _: state) {
+        ground.SetFields(fields);
+
+        indices.resize(ground.GetChunkCount());
+        for (size_t i=0; i < indices.size(); i++)
+            indices[i] = i;
+
+        ground.BuildChunks(indices);
+    }
+
+    state.SetItemsProcessed(state.iterations() * fields.size());
+}
+BENCHMARK(BM_GroundBuildChunksParallel)->Arg(128)->Arg(1024)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Tile lookups by position on a square ground of state.range(0)² fields.
+static void BM_GroundGetTileAt(benchmark::State& state)
+{
+    int edge = static_cast<int>(state.range(0));
+    Ground ground("green_3.png", make_square_ground(edge));
+
+    float extent = edge * 64.0f;
+    sf::Vector2f position(0.0f, 0.0f);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(ground.GetTileAt(position));
+        position.x = fmod(position.x + 97.0f, extent);
+        position.y = fmod(position.y + 61.0f, extent);
+    }
+}
+BENCHMARK(BM_GroundGetTileAt)->Arg(16)->Arg(1024);
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "i18n.hpp"
+#include "gui.hpp"
+#include "texture_cache.hpp"
+#include <xercesc/util/PlatformUtils.hpp>
+#include <benchmark/benchmark.h>
+
+using namespace TSC;
+
+/* Entry point of the benchmark suite. It performs the same global
+ * initialisation as the Application class, except that no window is
+ * opened. Like the game itself, the benchmarks read their data from
+ * the installation directory, so run "make install" first.
+ *
+ * Run with --benchmark_out=FILE --benchmark_out_format=json to get
+ * results that can be compared between commits, e.g. with the
+ * compare.py script that ships with Google Benchmark; the
+ * "benchmark_json" target does just that. */
+int main(int argc, char* argv[])
+{
+    SetupI18n();
+    xercesc::XMLPlatformUtils::Initialize();
+    GUI::Init();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+
+    GUI::Cleanup();
+    TextureCache::Cleanup();
+    xercesc::XMLPlatformUtils::Terminate();
+    return 0;
+}
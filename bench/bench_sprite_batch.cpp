@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "sprite_batch.hpp"
+#include "draw_list.hpp"
+#include <benchmark/benchmark.h>
+#include <SFML/Graphics.hpp>
+
+using namespace TSC;
+
+/* One frame of state.range(0) moving sprites from a 512x512 atlas of
+ * 32x32 frames: filling the batch, recording, sorting and drawing the
+ * draw list. Every eighth sprite is rotated to exercise the transform
+ * variant. */
+static void BM_SpriteBatch(benchmark::State& state)
+{
+    sf::RenderTexture target;
+    target.create(1024, 576);
+    sf::Texture atlas;
+    atlas.create(512, 512);
+
+    int count = static_cast<int>(state.range(0));
+    SpriteBatch batch(&atlas);
+    batch.Reserve(count);
+    DrawList list;
+    float offset = 0.0f;
+
+    for (auto _: state) {
+        batch.Clear();
+        for (int i=0; i < count; i++) {
+            sf::Vector2f position((i * 37) % 1024 + offset, (i * 53) % 576);
+            sf::IntRect frame((i % 16) * 32, (i / 16 % 16) * 32, 32, 32);
+
+            if (i % 8 == 0) {
+                sf::Transform transform;
+                transform.translate(position).rotate(offset * 10.0f);
+                batch.Add(transform, frame);
+            }
+            else {
+                batch.Add(position, frame);
+            }
+        }
+
+        list.Clear(target.getDefaultView());
+        batch.Record(list);
+        list.Sort();
+        list.Execute(target);
+        offset += 1.0f;
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SpriteBatch)->Arg(1000)->Arg(50000)->Unit(benchmark::kMicrosecond);
+
+// The same number of sprites drawn one by one as sf::Sprite, for comparison.
+static void BM_SpriteUnbatched(benchmark::State& state)
+{
+    sf::RenderTexture target;
+    target.create(1024, 576);
+    sf::Texture atlas;
+    atlas.create(512, 512);
+
+    int count = static_cast<int>(state.range(0));
+    sf::Sprite sprite(atlas);
+    float offset = 0.0f;
+
+    for (auto _: state) {
+        for (int i=0; i < count; i++) {
+            sprite.setPosition((i * 37) % 1024 + offset, (i * 53) % 576);
+            sprite.setTextureRect(sf::IntRect((i % 16) * 32, (i / 16 % 16) * 32, 32, 32));
+            sprite.setRotation(i % 8 == 0 ? offset * 10.0f : 0.0f);
+            target.draw(sprite);
+        }
+
+        offset += 1.0f;
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_SpriteUnbatched)->Arg(1000)->Arg(50000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "../tscproc/genmeta.hpp"
+#include <benchmark/benchmark.h>
+#include <png.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Writes a collision rectangle PNG of `rows' x `cols' tiles of
+ * 64x64 pixels to `path'. Every tile gets an L-shaped collision
+ * area so that the rectangle decomposition has some work to do. */
+static bool write_colrect_png(const string& path, int rows, int cols)
+{
+    const int tilesize = 64;
+    int width  = cols * tilesize;
+    int height = rows * tilesize;
+    vector<png_byte> pixels(width * height * 4, 0);
+
+    for (int y=0; y < height; y++) {
+        for (int x=0; x < width; x++) {
+            int tx = x % tilesize;
+            int ty = y % tilesize;
+            if (ty >= tilesize / 2 || tx < tilesize / 4)
+                pixels[(y * width + x) * 4 + 3] = 150;
+        }
+    }
+
+    png_image image = {};
+    image.version = PNG_IMAGE_VERSION;
+    image.width   = width;
+    image.height  = height;
+    image.format  = PNG_FORMAT_RGBA;
+
+    return png_image_write_to_file(&image, path.c_str(), 0, pixels.data(), 0, NULL) != 0;
+}
+
+// Collision rectangle extraction from a tileset of state.range(0)² tiles.
+static void BM_TscprocExtract(benchmark::State& state)
+{
+    int edge = static_cast<int>(state.range(0));
+    string path = "tsc-bench-colrects.png";
+
+    if (!write_colrect_png(path, edge, edge)) {
+        state.SkipWithError("Failed to write the collision rectangle PNG");
+        return;
+    }
+
+    for (auto _: state)
+        benchmark::DoNotOptimize(read_colrect_png(path, edge, edge));
+
+    state.SetItemsProcessed(state.iterations() * edge * edge);
+    remove(path.c_str());
+}
+BENCHMARK(BM_TscprocExtract)->Arg(4)->Arg(32)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,56 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "util.hpp"
+#include "xerces_helpers.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace TSC;
+using namespace std;
+
+static void BM_Utf8ToXstr(benchmark::State& state)
+{
+    string str(state.range(0), 'a');
+
+    for (auto _: state)
+        benchmark::DoNotOptimize(utf8_to_xstr(str));
+
+    state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(BM_Utf8ToXstr)->Arg(8)->Arg(256);
+
+static void BM_XstrToUtf8(benchmark::State& state)
+{
+    auto xstr = utf8_to_xstr(string(state.range(0), 'a'));
+
+    for (auto _: state)
+        benchmark::DoNotOptimize(xstr_to_utf8(xstr.get()));
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_XstrToUtf8)->Arg(8)->Arg(256);
+
+static void BM_Format(benchmark::State& state)
+{
+    for (auto _: state)
+        benchmark::DoNotOptimize(format("Texture '%s' exceeds %d pixels", "tilesets/green_3.png", 4096));
+}
+BENCHMARK(BM_Format);
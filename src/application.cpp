@@ -22,19 +22,44 @@
 #include "pathmap.hpp"
 #include "settings.hpp"
 #include "scenes/title_scene.hpp"
+#include "scenes/benchmark_scene.hpp"
 #include "texture_cache.hpp"
 #include "audio.hpp"
 #include "gui.hpp"
 #include "util.hpp"
 #include "i18n.hpp"
+#include "render_stats.hpp"
+#include "event_recording.hpp"
+#include "file_watcher.hpp"
+#include "jobs.hpp"
+#include "render_thread.hpp"
+#include "dynamic_resolution.hpp"
+#include "frame_limiter.hpp"
 #include <SFML/Graphics.hpp>
+#include <SFML/OpenGL.hpp>
 #include <xercesc/util/PlatformUtils.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
 
 using namespace TSC;
 using namespace std;
 
 static Application* sp_app = nullptr;
 
+// How much of a frame may be spent on uploading textures, in milliseconds.
+static const int TEXTURE_UPLOAD_BUDGET_MS = 4;
+
+// Frame time pretended when replaying recorded events, in seconds.
+static const float REPLAY_FRAME_TIME = 1.0f / 60.0f;
+
+// Frame rate of idle scenes (see Scene::IsIdle()), and how long there must have been no input before.
+static const int IDLE_FPS = 10;
+static const float IDLE_DELAY = 1.0f;
+
 /**
  * Returns the singleton instance of this class. Note that this method
  * returns a nullptr until the constructor has returned.
@@ -48,15 +73,49 @@ Application::Application(int argc, char* argv[])
     : m_terminate(false),
       m_frame_time(0.0f),
       m_global_scale(1.0f),
-      mp_intermediate_sprite(nullptr)
+      mp_intermediate_sprite(nullptr),
+      m_viewport(0.0f, 0.0f, 1.0f, 1.0f),
+      m_benchmark_frames(1000),
+      m_frame_count(0)
 {
     if (sp_app)
         throw(std::runtime_error("Can't have more than one Application instance!"));
 
+    bool single_thread = false;
+    for (int i=1; i < argc; i++) {
+        string arg(argv[i]);
+
+        if (arg == "--benchmark" && i + 1 < argc)
+            m_benchmark_level = argv[++i];
+        else if (arg == "--frames" && i + 1 < argc) {
+            // stoi() would throw std::invalid_argument for anything but a number
+            char* p_end = NULL;
+            long frames = strtol(argv[++i], &p_end, 10);
+            if (p_end == argv[i] || *p_end != '\0' || frames <= 0 || frames > INT_MAX)
+                throw(std::runtime_error("--frames requires a positive number"));
+
+            m_benchmark_frames = static_cast<int>(frames);
+        }
+        else if (arg == "--record" && i + 1 < argc)
+            mp_recorder.reset(new EventRecorder(argv[++i]));
+        else if (arg == "--replay" && i + 1 < argc)
+            mp_player.reset(new EventPlayer(argv[++i]));
+        else if (arg == "--single-thread")
+            single_thread = true;
+        else if (arg == "--benchmark" || arg == "--frames" || arg == "--record" || arg == "--replay")
+            throw(std::runtime_error("Usage: tsc [--benchmark LEVEL [--frames N]] [--record FILE | --replay FILE] [--single-thread]"));
+        else
+            warn("Ignoring unknown argument '" + arg + "'"); // E.g. -psn_* added by macOS
+    }
+
+    if (mp_recorder && mp_player)
+        throw(std::runtime_error("--record and --replay cannot be used together"));
+
     SetupI18n(); // Always call this first. It sets the programme's global locale.
     xercesc::XMLPlatformUtils::Initialize();
 
     Settings::Load();
+    Jobs::Init(single_thread ? 0 : Settings::worker_threads);
     GUI::Init();
 
     sp_app = this;
@@ -64,6 +123,8 @@ Application::Application(int argc, char* argv[])
 
 Application::~Application()
 {
+    TextureCache::Cleanup();
+    Jobs::Cleanup();
     GUI::Cleanup();
     Settings::Save();
 
@@ -75,6 +136,9 @@ Application::~Application()
 
 int Application::MainLoop()
 {
+    if (!m_benchmark_level.empty())
+        return RunBenchmark();
+
     OpenWindow();
 
     m_fps.setFont(GUI::NormalFont);
@@ -82,11 +146,40 @@ int Application::MainLoop()
     m_fps.setCharacterSize(TSC::GUI::NORMAL_FONT_SIZE);
     m_fps.setPosition(10, 10);
 
+    m_stage_view = sf::View(sf::FloatRect(0, 0, m_stage_rect.width, m_stage_rect.height));
+
+    // The scene is drawn into m_scene_target at a lower resolution if needed
+    if (Settings::enable_dynamic_resolution) {
+        if (!m_scene_target.create(m_stage_rect.width, m_stage_rect.height))
+            throw(runtime_error("Failed to create the render target for dynamic resolution"));
+
+        m_scene_target.setSmooth(true);
+        mp_dynamic_resolution.reset(new DynamicResolution(Settings::dynamic_resolution_budget / 1000.0f));
+    }
+
+    if (Settings::enable_render_thread)
+        mp_render_thread.reset(new RenderThread(m_window, [this](const DrawList& list){ Present(list); }));
+
+    // Replays must not depend on files changing meanwhile
+    if (Settings::enable_hot_reload && !mp_player) {
+        mp_file_watcher.reset(new FileWatcher());
+        mp_file_watcher->AddDirectory(Pathmap::GetDataPath());
+        mp_file_watcher->AddDirectory(Pathmap::GetUserLevelsPath());
+    }
+
     PushScene(unique_ptr<TitleScene>(new TitleScene()));
 
     // Game main loop
+    sf::Clock replay_clock;
+    sf::Clock input_clock; // Time since the last event
+    FrameLimiter limiter;
+    float work_time = 0.0f; // Time the last frame took without waiting for the limiter
     while (!m_terminate && !m_scene_stack.empty()) {
         m_frame_time = m_game_clock.restart().asSeconds();
+        if (mp_player)
+            m_frame_time = REPLAY_FRAME_TIME; // Deterministic replay
+
+        RenderStats::BeginFrame();
         unique_ptr<Scene>& p_scene = m_scene_stack.top();
 
         // Remove top scene and redo if it's finished.
@@ -95,59 +188,88 @@ int Application::MainLoop()
             continue;
         }
 
-        // Poll events from SFML
+        if (mp_player && mp_player->HasFinished(m_frame_count)) {
+            cout << format("Replay finished after %d frames in %.2f seconds",
+                           static_cast<int>(m_frame_count), replay_clock.getElapsedTime().asSeconds()) << endl;
+            break;
+        }
+
+        // Poll events from SFML (or the recording)
         sf::Event event;
-        while (m_window.pollEvent(event)) {
+        while (PollEvent(event)) {
             GUI::ProcessEvent(event, m_stage_rect.left, m_stage_rect.top);
             p_scene->ProcessEvent(event);
+            input_clock.restart();
         }
 
+        if (mp_file_watcher)
+            ReloadChangedFiles(*p_scene);
+
         p_scene->DoGUI(m_window);
         p_scene->Update(m_window);
 
         // Update audio system (especially for fading)
         Audio::Update();
 
-        // Draw scene
-        if (mp_intermediate_sprite) {
-            /* mp_intermediate_sprite is only set in fullscreen mode if the
-             * requested aspect ratio is not 16:9. The below code draws
-             * the scene into a 16:9 RenderTexture and then blits that
-             * one onto the actual window after that window has been
-             * cleared to black. The effect are black bars around the
-             * blitted RenderTexture. */
-            m_intermediate_target.clear(sf::Color::Black);
-            p_scene->Draw(m_intermediate_target);
-
-            // Draw GUI on top of it
-            GUI::Draw(m_intermediate_target);
-
-            // Flip texture's buffers
-            m_intermediate_target.display();
-
-            m_window.clear(sf::Color::Black);
-            m_window.draw(*mp_intermediate_sprite);
-        }
-        else {
-            m_window.clear(sf::Color::Black);
-            p_scene->Draw(m_window);
+        /* Upload textures decoded in the background, without hogging
+         * the frame. The render thread may still be drawing the last
+         * frame with the textures that are about to be replaced. */
+        if (mp_render_thread)
+            mp_render_thread->Finish();
 
-            // Draw GUI on top of it
-            GUI::Draw(m_window);
-        }
+        TextureCache::Update(sf::milliseconds(TEXTURE_UPLOAD_BUDGET_MS));
+
+        // Record scene, GUI on top of it, and FPS
+        m_draw_list.Clear(m_stage_view);
+        p_scene->Draw(m_draw_list);
+        m_draw_list.SetLayer(DrawList::LAYER_GUI);
+        GUI::Draw(m_draw_list);
 
-        // Draw FPS
         int fps = static_cast<int>(1.0f / m_frame_time);
         m_fps.setString(sformat(_("FPS: %d"), fps));
-        m_window.draw(m_fps);
+        m_draw_list.SetLayer(DrawList::LAYER_OVERLAY);
+        m_draw_list.AddDrawable(m_fps);
+        m_draw_list.Sort();
 
-        // Flip buffers
-        m_window.display();
+        if (mp_dynamic_resolution) {
+            mp_dynamic_resolution->Update(work_time);
+            m_draw_list.SetResolutionScale(mp_dynamic_resolution->GetScale());
+        }
 
-        // Late update for special tasks.
+        // Blits done by Present()
+        if (mp_intermediate_sprite)
+            RenderStats::CountDrawCall();
+        if (mp_dynamic_resolution)
+            RenderStats::CountDrawCall();
+
+        /* Draw it and flip buffers. With the render thread, this
+         * returns right away, and the next frame is updated while
+         * this one is drawn. */
+        if (mp_render_thread)
+            mp_render_thread->Submit(m_draw_list);
+        else
+            Present(m_draw_list);
+
+        // Cap the frame rate, with a lower one if idle. Replays run as fast as possible.
+        int max_fps = Settings::target_fps;
+        if (p_scene->IsIdle() && input_clock.getElapsedTime().asSeconds() >= IDLE_DELAY)
+            max_fps = max_fps > 0 ? min(max_fps, IDLE_FPS) : IDLE_FPS;
+
+        // Late update for special tasks. May pop `p_scene'.
         p_scene->LateUpdate();
+
+        m_frame_count++;
+
+        work_time = m_game_clock.getElapsedTime().asSeconds();
+        if (!mp_player)
+            limiter.Wait(max_fps);
     }
 
+    mp_render_thread.reset();
+
+    if (mp_recorder)
+        mp_recorder->Finish(m_frame_count);
+
     // If the mainloop was ended by m_terminate, end all the scenes
     // that still exist.
     if (!m_scene_stack.empty()) {
@@ -159,6 +281,110 @@ int Application::MainLoop()
     return 0;
 }
 
+/* Like sf::Window::pollEvent(), but records the events if --record
+ * was given. With --replay, the window's events are discarded (so
+ * that the window stays responsive) and the recorded ones returned. */
+bool Application::PollEvent(sf::Event& event)
+{
+    if (mp_player) {
+        while (m_window.pollEvent(event))
+            ; // Discard real input
+
+        return mp_player->Poll(m_frame_count, event);
+    }
+
+    if (!m_window.pollEvent(event))
+        return false;
+
+    if (mp_recorder)
+        mp_recorder->Record(m_frame_count, event);
+
+    return true;
+}
+
+/* Reloads the textures among the files changed on disk and lets
+ * `scene` reload whatever else it needs. */
+void Application::ReloadChangedFiles(Scene& scene)
+{
+    vector<Pathie::Path> changed;
+    if (!mp_file_watcher->Poll(changed))
+        return;
+
+    // Reloading changes textures and levels the render thread may be drawing
+    if (mp_render_thread)
+        mp_render_thread->Finish();
+
+    string pixmaps = Pathmap::GetPixmapsPath().utf8_str() + "/";
+    for (const Pathie::Path& path: changed) {
+        string str = path.utf8_str();
+        if (str.compare(0, pixmaps.size(), pixmaps) == 0)
+            TextureCache::Reload(str.substr(pixmaps.size()));
+
+        scene.ReloadFile(path);
+    }
+}
+
+/* Draws the recorded frame onto the window and flips its buffers.
+ * This runs on the render thread if there is one. */
+void Application::Present(const DrawList& list)
+{
+    if (mp_intermediate_sprite) {
+        /* mp_intermediate_sprite is only set in fullscreen mode if the
+         * requested aspect ratio is not 16:9 and post-processing is
+         * enabled. The below code draws the frame into a 16:9
+         * RenderTexture and then blits that one onto the actual window
+         * after that window has been cleared to black. The effect are
+         * black bars around the blitted RenderTexture. */
+        m_intermediate_target.clear(sf::Color::Black);
+        DrawStage(list, m_intermediate_target, sf::FloatRect(0.0f, 0.0f, 1.0f, 1.0f));
+
+        // Flip texture's buffers
+        m_intermediate_target.display();
+
+        m_window.clear(sf::Color::Black);
+        m_window.draw(*mp_intermediate_sprite);
+    }
+    else {
+        // Without post-processing, m_viewport leaves the black bars
+        m_window.clear(sf::Color::Black);
+        DrawStage(list, m_window, m_viewport);
+    }
+
+    m_window.display();
+}
+
+/* Draws the frame into `viewport` of `target`. With dynamic resolution,
+ * the scene is drawn into a part of m_scene_target first, as large as
+ * the list's resolution scale says, which is then scaled up onto the
+ * target. The GUI is drawn on top of that at full resolution. */
+void Application::DrawStage(const DrawList& list, sf::RenderTarget& target, const sf::FloatRect& viewport)
+{
+    if (!mp_dynamic_resolution) {
+        list.Execute(target, viewport);
+        return;
+    }
+
+    float scale = list.GetResolutionScale();
+    m_scene_target.clear(sf::Color::Black);
+    list.ExecuteLayers(m_scene_target, INT_MIN, DrawList::LAYER_GUI, sf::FloatRect(0.0f, 0.0f, scale, scale));
+    m_scene_target.display();
+
+    // Rounded like SFML does for the viewport
+    sf::Vector2u size = m_scene_target.getSize();
+    int width  = max(1, static_cast<int>(0.5f + size.x * scale));
+    int height = max(1, static_cast<int>(0.5f + size.y * scale));
+
+    sf::Sprite scene(m_scene_target.getTexture(), sf::IntRect(0, 0, width, height));
+    scene.setScale(static_cast<float>(size.x) / width, static_cast<float>(size.y) / height);
+
+    sf::View stage_view(sf::FloatRect(0.0f, 0.0f, size.x, size.y));
+    stage_view.setViewport(viewport);
+    target.setView(stage_view);
+    target.draw(scene);
+
+    list.ExecuteLayers(target, DrawList::LAYER_GUI, INT_MAX, viewport);
+}
+
 // Advises the programme to terminate the next time the main loop runs.
 void Application::Terminate()
 {
@@ -169,6 +395,116 @@ void Application::Terminate()
     m_terminate = true;
 }
 
+// Returns the given percentile of the sorted `values` (nearest rank).
+static float percentile(const vector<float>& values, float p)
+{
+    size_t rank = static_cast<size_t>(ceil(p * values.size()));
+    return values[rank > 0 ? rank - 1 : 0];
+}
+
+/**
+ * Main loop of the headless benchmark mode. Instead of a window, the
+ * intermediate render texture is used as the target for all drawing
+ * and no events are processed. Each frame is timed until the GPU has
+ * finished it, so that the numbers include the actual rendering.
+ */
+int Application::RunBenchmark()
+{
+    m_stage_rect   = sf::IntRect(0, 0, NATIVE_WIDTH, NATIVE_HEIGHT);
+    m_global_scale = 1.0f;
+
+    if (!m_intermediate_target.create(NATIVE_WIDTH, NATIVE_HEIGHT))
+        throw(runtime_error("Failed to create the offscreen render target"));
+
+    PushScene(unique_ptr<BenchmarkScene>(new BenchmarkScene(m_benchmark_level, m_benchmark_frames)));
+
+    vector<float> frame_times;
+    vector<unsigned int> draw_calls;
+    vector<unsigned int> state_changes;
+    vector<unsigned int> culled_grounds;
+    frame_times.reserve(m_benchmark_frames);
+    draw_calls.reserve(m_benchmark_frames);
+    state_changes.reserve(m_benchmark_frames);
+    culled_grounds.reserve(m_benchmark_frames);
+
+    sf::Clock clock;
+    while (!m_scene_stack.empty()) {
+        unique_ptr<Scene>& p_scene = m_scene_stack.top();
+
+        if (p_scene->HasFinished()) {
+            m_scene_stack.pop();
+            continue;
+        }
+
+        clock.restart();
+        RenderStats::BeginFrame();
+
+        p_scene->DoGUI(m_intermediate_target);
+        p_scene->Update(m_intermediate_target);
+        TextureCache::Update(sf::milliseconds(TEXTURE_UPLOAD_BUDGET_MS));
+
+        if (p_scene->HasFinished())
+            continue; // Update() ended the run; do not count an empty frame
+
+        m_draw_list.Clear(m_intermediate_target.getDefaultView());
+        p_scene->Draw(m_draw_list);
+        m_draw_list.SetLayer(DrawList::LAYER_GUI);
+        GUI::Draw(m_draw_list);
+        m_draw_list.Sort();
+
+        m_intermediate_target.clear(sf::Color::Black);
+        m_draw_list.Execute(m_intermediate_target);
+        m_intermediate_target.display();
+        glFinish(); // Wait for the GPU
+
+        p_scene->LateUpdate();
+
+        m_frame_time = clock.getElapsedTime().asSeconds();
+        frame_times.push_back(m_frame_time * 1000.0f);
+        draw_calls.push_back(RenderStats::GetDrawCalls());
+        state_changes.push_back(RenderStats::GetStateChanges());
+        culled_grounds.push_back(RenderStats::GetCulledGrounds());
+    }
+
+    if (frame_times.empty())
+        return 1;
+
+    float total = 0.0f;
+    for (float time: frame_times)
+        total += time;
+
+    unsigned int total_calls = 0;
+    for (unsigned int calls: draw_calls)
+        total_calls += calls;
+
+    unsigned int total_changes = 0;
+    for (unsigned int changes: state_changes)
+        total_changes += changes;
+
+    unsigned int total_culled = 0;
+    for (unsigned int culled: culled_grounds)
+        total_culled += culled;
+
+    sort(frame_times.begin(), frame_times.end());
+    cout << format("Benchmark: %s, %d frames at %dx%d", m_benchmark_level.c_str(), static_cast<int>(frame_times.size()), NATIVE_WIDTH, NATIVE_HEIGHT) << endl
+         << format("Frame time (ms): mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f",
+                   total / frame_times.size(),
+                   percentile(frame_times, 0.5f),
+                   percentile(frame_times, 0.9f),
+                   percentile(frame_times, 0.99f),
+                   frame_times.back()) << endl
+         << format("Draw calls per frame: mean %.1f  max %u",
+                   static_cast<float>(total_calls) / draw_calls.size(),
+                   *max_element(draw_calls.begin(), draw_calls.end())) << endl
+         << format("State changes per frame: mean %.1f  max %u",
+                   static_cast<float>(total_changes) / state_changes.size(),
+                   *max_element(state_changes.begin(), state_changes.end())) << endl
+         << format("Culled grounds per frame: mean %.1f",
+                   static_cast<float>(total_culled) / culled_grounds.size()) << endl;
+
+    return 0;
+}
+
 static sf::IntRect calc_best_stage_size(sf::Vector2u winsize)
 {
     static const float native_ar = 1920.0f / 1080.0f;
@@ -209,12 +545,23 @@ void Application::OpenWindow()
     if (Settings::enable_fullscreen) {
         style = sf::Style::Fullscreen;
 
-        // Enable the intermediate target if the requested aspect ratio
-        // is not 16:9 (see comments in main loop).
+        /* If the requested aspect ratio is not 16:9, the stage is
+         * letterboxed (see Present()). Post-processing needs the whole
+         * frame in a texture, so it uses the intermediate target; the
+         * window's viewport suffices otherwise and saves drawing the
+         * whole screen a second time. */
         if (m_stage_rect.left != 0 || m_stage_rect.top != 0) { // One of them is set to nonzero if not 16:9
-            m_intermediate_target.create(m_stage_rect.width, m_stage_rect.height);
-            mp_intermediate_sprite = new sf::Sprite(m_intermediate_target.getTexture());
-            mp_intermediate_sprite->setPosition(m_stage_rect.left, m_stage_rect.top);
+            if (Settings::enable_postprocessing) {
+                m_intermediate_target.create(m_stage_rect.width, m_stage_rect.height);
+                mp_intermediate_sprite = new sf::Sprite(m_intermediate_target.getTexture());
+                mp_intermediate_sprite->setPosition(m_stage_rect.left, m_stage_rect.top);
+            }
+            else {
+                m_viewport = sf::FloatRect(static_cast<float>(m_stage_rect.left)   / mode.width,
+                                           static_cast<float>(m_stage_rect.top)    / mode.height,
+                                           static_cast<float>(m_stage_rect.width)  / mode.width,
+                                           static_cast<float>(m_stage_rect.height) / mode.height);
+            }
         }
     }
     else {
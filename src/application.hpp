@@ -20,14 +20,22 @@
 
 #ifndef TSC_APPLICATION_HPP
 #define TSC_APPLICATION_HPP
+#include <cstdint>
 #include <memory>
 #include <stack>
+#include <string>
 #include <SFML/Graphics.hpp>
+#include "draw_list.hpp"
 
 namespace TSC {
 
     // forward-declare
     class Scene;
+    class EventRecorder;
+    class EventPlayer;
+    class FileWatcher;
+    class RenderThread;
+    class DynamicResolution;
 
     // This is the native resolution.
     const int NATIVE_WIDTH = 1920;
@@ -45,6 +53,45 @@ namespace TSC {
      * global information that were to small to warrant its own global object.
      * For example, this class thus contains the FPS counter. It also holds the
      * scene stack and owns the SFML game window.
+     *
+     * If started with `--benchmark LEVEL [--frames N]`, no window is opened.
+     * Instead, a BenchmarkScene renders N frames of the given level into an
+     * offscreen render texture and the frame time percentiles and draw call
+     * counts are printed to standard output. Since no user input is involved,
+     * this can be run on machines without a real graphics card, e.g. with
+     * Mesa's software renderer under Xvfb.
+     *
+     * With `--record FILE`, all events received from the window are written
+     * to FILE along with the frame they arrived in. `--replay FILE` feeds
+     * them back into the main loop in the very same frames instead of real
+     * input, with a fixed frame time, and ends the programme when the
+     * recording ends. This allows profiling the exact same session before
+     * and after a change. `--single-thread` runs all jobs of the job
+     * system on the thread submitting them (see Jobs), which makes
+     * debugging easier.
+     *
+     * If Settings::enable_hot_reload is set, the data directory and the
+     * user's level directory are watched for changes (see FileWatcher).
+     * Changed textures are reloaded in the TextureCache, and the active
+     * scene is told about each changed file so that it can reload its
+     * level or tilesets (see Scene::ReloadFile()). This way, levels and
+     * graphics can be worked on without restarting the game.
+     *
+     * Each frame, the active scene and the GUI are recorded into a
+     * DrawList, which is then drawn onto the window. If
+     * Settings::enable_render_thread is set, that happens on a
+     * RenderThread, so that the next frame is updated while the
+     * current one is drawn and the window waits for vsync.
+     *
+     * With Settings::enable_dynamic_resolution, the scene is drawn at a
+     * lower resolution when frames take longer than the configured
+     * budget, and scaled up to the stage; the GUI is not affected (see
+     * DynamicResolution).
+     *
+     * Settings::target_fps caps the frame rate (see FrameLimiter). Scenes
+     * that are idle (see Scene::IsIdle()) are drawn at a low frame rate
+     * once there has been no input for a moment, so that e.g. the title
+     * screen does not keep the CPU busy.
      */
     class Application {
     public:
@@ -62,20 +109,38 @@ namespace TSC {
         inline sf::IntRect GetStageRect() const { return m_stage_rect; }
         inline sf::Vector2f GetGlobalScaleVec() const { return sf::Vector2f(m_global_scale, m_global_scale); }
         inline float GetGlobalScale() const { return m_global_scale; }
+        inline float GetFrameTime() const { return m_frame_time; }
 
     private:
         bool m_terminate;
         float m_frame_time; // How long executing the last frame took in total, in seconds.
         float m_global_scale;
         sf::IntRect m_stage_rect;
-        sf::Sprite* mp_intermediate_sprite; // Only used if fullscreen mode and non-native aspect ratio
-        sf::RenderTexture m_intermediate_target; // Only used if fullscreen mode and non-native aspect ratio
+        sf::Sprite* mp_intermediate_sprite; // Only used if fullscreen mode, non-native aspect ratio and post-processing
+        sf::RenderTexture m_intermediate_target; // Only used if fullscreen mode, non-native aspect ratio and post-processing, or in benchmark mode
+        sf::FloatRect m_viewport; // Part of the window showing the stage if letterboxed without m_intermediate_target
+        sf::RenderTexture m_scene_target; // Only used with Settings::enable_dynamic_resolution
         sf::RenderWindow m_window;
         sf::Clock m_game_clock;
         sf::Text m_fps;
         std::stack<std::unique_ptr<Scene>> m_scene_stack;
+        std::string m_benchmark_level; // Headless benchmark mode if set
+        int m_benchmark_frames;
+        uint64_t m_frame_count; // Number of main loop iterations done
+        std::unique_ptr<EventRecorder> mp_recorder; // Only set with --record
+        std::unique_ptr<EventPlayer> mp_player;     // Only set with --replay
+        std::unique_ptr<FileWatcher> mp_file_watcher; // Only set with Settings::enable_hot_reload
+        std::unique_ptr<RenderThread> mp_render_thread; // Only set with Settings::enable_render_thread
+        std::unique_ptr<DynamicResolution> mp_dynamic_resolution; // Only set with Settings::enable_dynamic_resolution
+        DrawList m_draw_list; // Recording of the current frame
+        sf::View m_stage_view; // Default view of the target the scenes are drawn onto
 
         void OpenWindow();
+        int RunBenchmark();
+        bool PollEvent(sf::Event& event);
+        void ReloadChangedFiles(Scene& scene);
+        void Present(const DrawList& list);
+        void DrawStage(const DrawList& list, sf::RenderTarget& target, const sf::FloatRect& viewport);
     };
 }
 
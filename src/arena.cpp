@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+using namespace TSC;
+using namespace std;
+
+const size_t Arena::DEFAULT_BLOCK_SIZE;
+
+Arena::Arena(size_t block_size)
+    : mp_current(nullptr),
+      m_remaining(0),
+      m_block_size(block_size),
+      m_first_block_size(block_size),
+      m_reserved_bytes(0)
+{
+}
+
+/**
+ * Returns `size` bytes of memory aligned to `alignment`, which must
+ * be a power of two not larger than alignof(std::max_align_t). The
+ * memory stays valid until the arena is released.
+ */
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(mp_current) % alignment) % alignment;
+
+    if (!mp_current || padding + size > m_remaining) {
+        // Blocks from new[] are suitably aligned for anything
+        size_t block_size = max(m_block_size, size);
+        m_blocks.emplace_back(new char[block_size]);
+        m_reserved_bytes += block_size;
+        m_block_size *= 2;
+
+        mp_current  = m_blocks.back().get();
+        m_remaining = block_size;
+        padding     = 0;
+    }
+
+    void* p_memory = mp_current + padding;
+    mp_current  += padding + size;
+    m_remaining -= padding + size;
+    return p_memory;
+}
+
+/**
+ * Frees all memory allocated from the arena at once. Anything still
+ * using it must not be touched anymore afterwards. The arena can be
+ * used again.
+ */
+void Arena::Release()
+{
+    m_blocks.clear();
+    mp_current       = nullptr;
+    m_remaining      = 0;
+    m_block_size     = m_first_block_size;
+    m_reserved_bytes = 0;
+}
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_ARENA_HPP
+#define TSC_ARENA_HPP
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace TSC {
+
+    /**
+     * A monotonic memory arena for data that is created in bulk and
+     * thrown away all at once, like the scratch data of the level
+     * loader. Allocate() hands out memory from large blocks and never
+     * frees single allocations; all the memory is freed at once by
+     * Release() or the destructor. This replaces many small heap
+     * allocations with a few large ones.
+     *
+     * Standard containers can use an Arena via ArenaAllocator. This
+     * is what std::pmr::monotonic_buffer_resource does in C++17.
+     */
+    class Arena
+    {
+    public:
+        /// Size of the first block; each further block is twice as large.
+        static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        Arena(size_t block_size = DEFAULT_BLOCK_SIZE);
+
+        void* Allocate(size_t size, size_t alignment);
+        void Release();
+        /// Memory taken from the heap, in bytes.
+        inline size_t GetReservedBytes() const { return m_reserved_bytes; }
+    private:
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        std::vector<std::unique_ptr<char[]>> m_blocks;
+        char* mp_current;      // Next free byte in the last block
+        size_t m_remaining;    // Bytes left after mp_current
+        size_t m_block_size;   // Size of the next block
+        size_t m_first_block_size;
+        size_t m_reserved_bytes;
+    };
+
+    /**
+     * Allocator for standard containers that takes its memory from
+     * an Arena. Deallocation does nothing; the memory is reclaimed
+     * when the arena is released, so the arena must outlive the
+     * container. Containers that grow leave their old buffers in
+     * the arena; reserve() beforehand if the size is known.
+     */
+    template<typename T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+
+        ArenaAllocator(Arena& arena)
+            : mp_arena(&arena) {}
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other)
+            : mp_arena(other.GetArena()) {}
+
+        T* allocate(size_t count)
+        {
+            return static_cast<T*>(mp_arena->Allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T*, size_t) {}
+
+        inline Arena* GetArena() const { return mp_arena; }
+    private:
+        Arena* mp_arena;
+    };
+
+    template<typename T, typename U>
+    inline bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.GetArena() == b.GetArena(); }
+    template<typename T, typename U>
+    inline bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return !(a == b); }
+
+}
+
+#endif /* TSC_ARENA_HPP */
@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "camera.hpp"
+#include "application.hpp"
+
+using namespace TSC;
+using namespace std;
+
+/**
+ * Creates a camera without limits showing the area from (0|0) to
+ * (NATIVE_WIDTH|NATIVE_HEIGHT).
+ */
+Camera::Camera()
+    : m_zoom(1.0f),
+      m_scroll_speed(0.0f),
+      m_view(sf::FloatRect(0, 0, NATIVE_WIDTH, NATIVE_HEIGHT))
+{
+}
+
+/**
+ * Restricts the camera to the given area. An empty rectangle
+ * removes the limits.
+ */
+void Camera::SetLimits(const sf::FloatRect& limits)
+{
+    m_limits = limits;
+    UpdateView(m_view.getCenter());
+}
+
+void Camera::SetCenter(const sf::Vector2f& center)
+{
+    UpdateView(center);
+}
+
+void Camera::Move(const sf::Vector2f& offset)
+{
+    UpdateView(m_view.getCenter() + offset);
+}
+
+/**
+ * Changes the zoom factor while keeping the center. Values of
+ * zero and less are ignored.
+ */
+void Camera::SetZoom(float zoom)
+{
+    if (zoom <= 0.0f)
+        return;
+
+    m_zoom = zoom;
+    UpdateView(m_view.getCenter());
+}
+
+/**
+ * Advances the camera by `elapsed` seconds, i.e. scrolls it if
+ * a scrolling speed is set.
+ */
+void Camera::Update(float elapsed)
+{
+    if (m_scroll_speed != 0.0f)
+        Move(sf::Vector2f(m_scroll_speed * elapsed, 0.0f));
+}
+
+/// Returns the area of the level that is currently visible.
+sf::FloatRect Camera::GetVisibleArea() const
+{
+    return sf::FloatRect(m_view.getCenter() - m_view.getSize() / 2.0f, m_view.getSize());
+}
+
+/* Sets the view to the given center and the current zoom, moving
+ * it back into the limits where needed. If the limits are smaller
+ * than the visible area in one direction, the camera is centered
+ * on the limits in that direction. */
+void Camera::UpdateView(sf::Vector2f center)
+{
+    sf::Vector2f size(NATIVE_WIDTH / m_zoom, NATIVE_HEIGHT / m_zoom);
+
+    if (m_limits.width > 0.0f && m_limits.height > 0.0f) {
+        if (size.x >= m_limits.width)
+            center.x = m_limits.left + m_limits.width / 2.0f;
+        else if (center.x - size.x / 2.0f < m_limits.left)
+            center.x = m_limits.left + size.x / 2.0f;
+        else if (center.x + size.x / 2.0f > m_limits.left + m_limits.width)
+            center.x = m_limits.left + m_limits.width - size.x / 2.0f;
+
+        if (size.y >= m_limits.height)
+            center.y = m_limits.top + m_limits.height / 2.0f;
+        else if (center.y - size.y / 2.0f < m_limits.top)
+            center.y = m_limits.top + size.y / 2.0f;
+        else if (center.y + size.y / 2.0f > m_limits.top + m_limits.height)
+            center.y = m_limits.top + m_limits.height - size.y / 2.0f;
+    }
+
+    m_view.setSize(size);
+    m_view.setCenter(center);
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_CAMERA_HPP
+#define TSC_CAMERA_HPP
+#include <SFML/Graphics.hpp>
+
+namespace TSC {
+
+    /**
+     * The camera decides which part of the level is visible. It is
+     * described by the position of its center and a zoom factor, where
+     * a zoom of 1 shows an area of NATIVE_WIDTH x NATIVE_HEIGHT pixels,
+     * 2 shows half as much and so on. The camera never shows anything
+     * outside of its limits, which usually are the level's boundaries;
+     * positions that would do so are corrected.
+     *
+     * Levels with a fixed camera speed scroll the camera to the right
+     * at that speed on each Update(), regardless of the player.
+     *
+     * Apply the camera with `target.setView(camera.GetView())`.
+     */
+    class Camera
+    {
+    public:
+        Camera();
+
+        void SetLimits(const sf::FloatRect& limits);
+        void SetCenter(const sf::Vector2f& center);
+        void Move(const sf::Vector2f& offset);
+        void SetZoom(float zoom);
+        /// Horizontal scrolling speed in pixels per second; 0 disables scrolling.
+        inline void SetScrollSpeed(float speed) { m_scroll_speed = speed; }
+
+        void Update(float elapsed);
+
+        inline const sf::FloatRect& GetLimits() const { return m_limits; }
+        inline sf::Vector2f GetCenter() const { return m_view.getCenter(); }
+        inline float GetZoom() const { return m_zoom; }
+        inline float GetScrollSpeed() const { return m_scroll_speed; }
+        inline const sf::View& GetView() const { return m_view; }
+        sf::FloatRect GetVisibleArea() const;
+    private:
+        void UpdateView(sf::Vector2f center);
+
+        float m_zoom;
+        float m_scroll_speed;
+        sf::FloatRect m_limits;
+        sf::View m_view;
+    };
+
+}
+
+#endif /* TSC_CAMERA_HPP */
@@ -0,0 +1,407 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "draw_list.hpp"
+#include "render_stats.hpp"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+using namespace TSC;
+using namespace std;
+
+// See LockFonts().
+static mutex s_font_mutex;
+
+const int DrawList::LAYER_SCENE;
+const int DrawList::LAYER_GUI;
+const int DrawList::LAYER_OVERLAY;
+
+// Whether consecutive vertex ranges of this type can be drawn as one.
+static bool is_mergeable(sf::PrimitiveType type)
+{
+    return type == sf::Points || type == sf::Lines || type == sf::Triangles || type == sf::Quads;
+}
+
+static bool transform_equal(const sf::Transform& a, const sf::Transform& b)
+{
+    return equal(a.getMatrix(), a.getMatrix() + 16, b.getMatrix());
+}
+
+// Returns `view` with its viewport placed into `viewport` of the target.
+static sf::View apply_viewport(sf::View view, const sf::FloatRect& viewport)
+{
+    const sf::FloatRect& own = view.getViewport();
+    view.setViewport(sf::FloatRect(viewport.left + own.left * viewport.width,
+                                   viewport.top  + own.top  * viewport.height,
+                                   own.width  * viewport.width,
+                                   own.height * viewport.height));
+    return view;
+}
+
+/// Creates an empty list that starts drawing with the default view.
+DrawList::DrawList()
+{
+    Clear(sf::View());
+}
+
+/// Creates an empty list that starts drawing with the given view.
+DrawList::DrawList(const sf::View& view)
+{
+    Clear(view);
+}
+
+/**
+ * Empties the list for recording the next frame, which starts with
+ * the given view; usually that is the target's default view. Layer,
+ * depth and resolution scale are reset to LAYER_SCENE, zero and one.
+ * The shared resources the list referred to are released.
+ */
+void DrawList::Clear(const sf::View& view)
+{
+    m_layer  = LAYER_SCENE;
+    m_depth  = 0.0f;
+    m_resolution_scale = 1.0f;
+    m_sorted = false;
+
+    m_commands.clear();
+    m_vertices.clear();
+    m_views.clear();
+    m_views.push_back(view);
+    m_drawables.clear();
+    m_texts.clear();
+    m_callbacks.clear();
+#ifdef TSC_HAVE_VERTEX_BUFFER
+    m_buffers.clear();
+#endif
+    m_order.clear();
+    m_batches.clear();
+    m_batch_vertices.clear();
+}
+
+/// Like sf::RenderTarget::setView() for everything added afterwards.
+void DrawList::SetView(const sf::View& view)
+{
+    m_views.push_back(view);
+}
+
+/// Sets the layer of everything added afterwards.
+void DrawList::SetLayer(int layer)
+{
+    m_layer = layer;
+}
+
+/// Sets the depth within the layer of everything added afterwards.
+void DrawList::SetDepth(float depth)
+{
+    m_depth = depth;
+}
+
+/**
+ * Sets the resolution the scene (everything below LAYER_GUI) is to be
+ * drawn at, relative to the stage size. The list does not use this
+ * itself; it is handed to Application::Present() along with the
+ * frame, which may draw the scene into a smaller texture and scale
+ * it up (see DynamicResolution).
+ */
+void DrawList::SetResolutionScale(float scale)
+{
+    m_resolution_scale = scale;
+}
+
+/**
+ * Adds a copy of the given vertices, which are drawn like
+ * sf::RenderTarget::draw() would draw them.
+ */
+void DrawList::AddVertices(const sf::Vertex* p_vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states)
+{
+    if (count == 0)
+        return;
+
+    Command& cmd  = AddCommand(CommandType::Vertices, states);
+    cmd.primitive = type;
+    cmd.index     = m_vertices.size();
+    cmd.count     = count;
+    m_vertices.insert(m_vertices.end(), p_vertices, p_vertices + count);
+}
+
+#ifdef TSC_HAVE_VERTEX_BUFFER
+/**
+ * Adds the first `count` vertices of the given vertex buffer. The
+ * list shares ownership of the buffer; its contents must not change
+ * until the list has been executed. Create a new buffer instead if
+ * the list is still in use.
+ */
+void DrawList::AddVertexBuffer(shared_ptr<const sf::VertexBuffer> p_buffer, size_t count, const sf::RenderStates& states)
+{
+    if (count == 0)
+        return;
+
+    Command& cmd = AddCommand(CommandType::VertexBuffer, states);
+    cmd.index    = m_buffers.size();
+    cmd.count    = count;
+    m_buffers.push_back(move(p_buffer));
+}
+#endif
+
+/**
+ * Adds the given sprite as a textured quad, which can be merged with
+ * other quads using the same texture.
+ */
+void DrawList::AddDrawable(const sf::Sprite& sprite, const sf::RenderStates& states)
+{
+    if (!sprite.getTexture())
+        return; // SFML does not draw these either
+
+    sf::FloatRect bounds = sprite.getLocalBounds();
+    sf::IntRect rect     = sprite.getTextureRect();
+    sf::Transform transform = states.transform * sprite.getTransform();
+
+    float left   = static_cast<float>(rect.left);
+    float top    = static_cast<float>(rect.top);
+    float right  = left + rect.width;
+    float bottom = top  + rect.height;
+
+    sf::Vertex quad[4] = {
+        sf::Vertex(transform.transformPoint(0.0f,         0.0f),          sprite.getColor(), sf::Vector2f(left,  top)),
+        sf::Vertex(transform.transformPoint(bounds.width, 0.0f),          sprite.getColor(), sf::Vector2f(right, top)),
+        sf::Vertex(transform.transformPoint(bounds.width, bounds.height), sprite.getColor(), sf::Vector2f(right, bottom)),
+        sf::Vertex(transform.transformPoint(0.0f,         bounds.height), sprite.getColor(), sf::Vector2f(left,  bottom))
+    };
+
+    // The transformation is applied already, so that differently placed sprites can be merged
+    sf::RenderStates quadstates(states);
+    quadstates.transform = sf::Transform::Identity;
+    quadstates.texture   = sprite.getTexture();
+    AddVertices(quad, 4, sf::Quads, quadstates);
+}
+
+/**
+ * Adds a copy of the given text. Unlike other drawables, a text loads
+ * missing glyphs from its font when it is drawn, so Execute() draws
+ * texts with the font lock held (see LockFonts()).
+ */
+void DrawList::AddDrawable(const sf::Text& text, const sf::RenderStates& states)
+{
+    Command& cmd = AddCommand(CommandType::Text, states);
+    cmd.p_texture_key = text.getFont(); // Its texture may change until drawn
+    cmd.index = m_texts.size();
+    m_texts.push_back(text);
+}
+
+/**
+ * Adds a function that draws onto the target when the list is
+ * executed, possibly on another thread. Use this for draw calls that
+ * need more than the render states, like setting shader uniforms.
+ * Whatever the function refers to must be captured by value (or by
+ * shared pointer), as the objects drawn may have changed or be gone
+ * when the list is executed. `states` are only used for sorting and
+ * should name the shader and texture the function draws with.
+ */
+void DrawList::AddCallback(function<void(sf::RenderTarget&)> callback, const sf::RenderStates& states)
+{
+    Command& cmd = AddCommand(CommandType::Callback, states);
+    cmd.index = m_callbacks.size();
+    m_callbacks.push_back(move(callback));
+}
+
+void DrawList::AddOwnedDrawable(unique_ptr<sf::Drawable> p_drawable, const sf::RenderStates& states)
+{
+    Command& cmd = AddCommand(CommandType::Drawable, states);
+    cmd.index = m_drawables.size();
+    m_drawables.push_back(move(p_drawable));
+}
+
+// Appends a command with the current layer, depth and view.
+DrawList::Command& DrawList::AddCommand(CommandType type, const sf::RenderStates& states)
+{
+    m_commands.emplace_back();
+    m_sorted = false;
+
+    Command& cmd      = m_commands.back();
+    cmd.type          = type;
+    cmd.primitive     = sf::Points;
+    cmd.states        = states;
+    cmd.layer         = m_layer;
+    cmd.depth         = m_depth;
+    cmd.p_texture_key = states.texture;
+    cmd.view          = static_cast<uint32_t>(m_views.size() - 1);
+    cmd.sequence      = static_cast<uint32_t>(m_commands.size() - 1);
+    cmd.index         = 0;
+    cmd.count         = 0;
+    return cmd;
+}
+
+// Orders by layer, depth, shader, texture, and then the order of adding.
+bool DrawList::CommandLess(uint32_t a, uint32_t b) const
+{
+    const Command& left  = m_commands[a];
+    const Command& right = m_commands[b];
+
+    if (left.layer != right.layer)
+        return left.layer < right.layer;
+    if (left.depth != right.depth)
+        return left.depth < right.depth;
+    if (left.states.shader != right.states.shader)
+        return less<const sf::Shader*>()(left.states.shader, right.states.shader);
+    if (left.p_texture_key != right.p_texture_key)
+        return less<const void*>()(left.p_texture_key, right.p_texture_key);
+
+    return left.sequence < right.sequence;
+}
+
+// Whether `b` can be drawn in the same draw call as `a`.
+bool DrawList::CanMerge(const Command& a, const Command& b) const
+{
+    return a.type == CommandType::Vertices && b.type == CommandType::Vertices
+        && a.primitive == b.primitive && is_mergeable(a.primitive)
+        && a.view == b.view
+        && a.states.texture == b.states.texture
+        && a.states.shader == b.states.shader
+        && a.states.blendMode == b.states.blendMode
+        && transform_equal(a.states.transform, b.states.transform);
+}
+
+/**
+ * Orders the commands by their sort keys and merges vertex ranges
+ * that can be drawn together. Call this from the main thread after
+ * recording, as it counts the draw calls and state changes (texture,
+ * shader or view) of the list in RenderStats.
+ */
+void DrawList::Sort()
+{
+    m_order.resize(m_commands.size());
+    for (size_t i=0; i < m_order.size(); i++)
+        m_order[i] = static_cast<uint32_t>(i);
+
+    sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) { return CommandLess(a, b); });
+
+    m_batches.clear();
+    m_batch_vertices.clear();
+    const Command* p_previous = nullptr;
+    unsigned int state_changes = 0;
+
+    for (uint32_t index: m_order) {
+        const Command& cmd = m_commands[index];
+
+        if (p_previous && CanMerge(*p_previous, cmd)) {
+            m_batch_vertices.insert(m_batch_vertices.end(), m_vertices.begin() + cmd.index, m_vertices.begin() + cmd.index + cmd.count);
+            m_batches.back().count += cmd.count;
+            continue;
+        }
+
+        if (!p_previous || p_previous->p_texture_key != cmd.p_texture_key)
+            state_changes++;
+        if (!p_previous || p_previous->states.shader != cmd.states.shader)
+            state_changes++;
+        if (!p_previous || p_previous->view != cmd.view)
+            state_changes++;
+
+        Batch batch;
+        batch.command = index;
+        batch.first   = m_batch_vertices.size();
+        batch.count   = cmd.count;
+        if (cmd.type == CommandType::Vertices)
+            m_batch_vertices.insert(m_batch_vertices.end(), m_vertices.begin() + cmd.index, m_vertices.begin() + cmd.index + cmd.count);
+
+        m_batches.push_back(batch);
+        p_previous = &cmd;
+    }
+
+    m_sorted = true;
+    RenderStats::CountDrawCall(static_cast<unsigned int>(m_batches.size()));
+    RenderStats::CountStateChange(state_changes);
+}
+
+/**
+ * Draws everything in the list onto `target` in the order determined
+ * by Sort(), which must have been called after the last command was
+ * added. The list is not changed, and may be executed on a different
+ * thread than the one recording it as long as only one thread uses
+ * it at a time.
+ *
+ * `viewport` is the part of the target to draw into, in the same
+ * ratios as sf::View::setViewport(); the viewports of the views in
+ * the list are taken relative to it. This allows letterboxing the
+ * frame without drawing it into an extra texture first.
+ */
+void DrawList::Execute(sf::RenderTarget& target, const sf::FloatRect& viewport) const
+{
+    ExecuteLayers(target, INT_MIN, INT_MAX, viewport);
+}
+
+/**
+ * Like Execute(), but only draws the layers from `first_layer` up to,
+ * but not including, `end_layer`. This allows drawing the scene and
+ * the GUI onto different targets.
+ */
+void DrawList::ExecuteLayers(sf::RenderTarget& target, int first_layer, int end_layer, const sf::FloatRect& viewport) const
+{
+    if (!m_sorted && !m_commands.empty())
+        throw(runtime_error("DrawList::Execute() called without Sort()"));
+
+    uint32_t view = 0;
+    target.setView(apply_viewport(m_views[view], viewport));
+
+    for (const Batch& batch: m_batches) {
+        const Command& cmd = m_commands[batch.command];
+        if (cmd.layer < first_layer)
+            continue;
+        if (cmd.layer >= end_layer)
+            break; // Batches are ordered by layer
+
+        if (cmd.view != view) {
+            view = cmd.view;
+            target.setView(apply_viewport(m_views[view], viewport));
+        }
+
+        switch (cmd.type) {
+        case CommandType::Vertices:
+            target.draw(&m_batch_vertices[batch.first], batch.count, cmd.primitive, cmd.states);
+            break;
+        case CommandType::VertexBuffer:
+#ifdef TSC_HAVE_VERTEX_BUFFER
+            target.draw(*m_buffers[cmd.index], 0, cmd.count, cmd.states);
+#endif
+            break;
+        case CommandType::Drawable:
+            target.draw(*m_drawables[cmd.index], cmd.states);
+            break;
+        case CommandType::Text: {
+            lock_guard<mutex> lock(s_font_mutex);
+            target.draw(m_texts[cmd.index], cmd.states);
+        } break;
+        case CommandType::Callback:
+            m_callbacks[cmd.index](target);
+            break;
+        } // No default clause so the compiler can warn about missing values
+    }
+}
+
+/**
+ * sf::Font loads glyphs into its textures on demand, both when a
+ * text is measured and when it is drawn. Code that measures texts
+ * while a DrawList may be executed on the render thread must hold
+ * the lock returned by this function.
+ */
+unique_lock<mutex> DrawList::LockFonts()
+{
+    return unique_lock<mutex>(s_font_mutex);
+}
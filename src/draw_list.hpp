@@ -0,0 +1,177 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_DRAW_LIST_HPP
+#define TSC_DRAW_LIST_HPP
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+// sf::VertexBuffer was added in SFML 2.5
+#if SFML_VERSION_MAJOR > 2 || (SFML_VERSION_MAJOR == 2 && SFML_VERSION_MINOR >= 5)
+#define TSC_HAVE_VERTEX_BUFFER
+#endif
+
+namespace TSC {
+
+    /**
+     * A recording of everything drawn in one frame. Scenes do not draw
+     * onto the render target directly, but add their vertices and
+     * drawables to a DrawList (see Scene::Draw()), which is executed
+     * on the target afterwards with Execute(). Everything is copied
+     * into the list, so that it does not change when the scene goes
+     * on with the next frame; graphics card resources the list refers
+     * to, like the vertex buffers of the Ground, are kept alive by
+     * shared pointers. This allows the main loop to hand the list to
+     * a separate render thread (see RenderThread) and update the next
+     * frame while the current one is being drawn.
+     *
+     * The order of drawing is not the order things are added in.
+     * Each command has a sort key made up of, in this order:
+     *
+     * 1. the *layer* (SetLayer()), e.g. LAYER_SCENE or LAYER_GUI;
+     * 2. the *depth* within the layer (SetDepth()), lower first;
+     * 3. the shader and
+     * 4. the texture it is drawn with.
+     *
+     * Commands with the same layer and depth must thus not overlap,
+     * or their order does not matter; where it does, like for the
+     * windows of the GUI, give each command its own depth. Sort()
+     * orders the commands by their keys, so that commands using the
+     * same texture end up next to each other, and merges neighbouring
+     * vertex ranges with the same render states into a single draw
+     * call. Sprites are added as vertices, so they can be merged, too.
+     * Sort() must be called between recording and Execute(); it also
+     * counts the resulting draw calls and state changes in RenderStats.
+     *
+     * Textures given in the render states are not copied. They must
+     * not be changed or deleted until the list has been executed;
+     * textures from the TextureCache fulfil this, as the main loop
+     * does not upload new textures while a list is being drawn.
+     * Shaders need their uniforms set right before drawing, which is
+     * what AddCallback() is for.
+     *
+     * Clear() keeps the memory of the list, so reusing a DrawList
+     * each frame avoids most allocations.
+     */
+    class DrawList
+    {
+    public:
+        /// The level or whatever else the scene shows.
+        static const int LAYER_SCENE = 0;
+        /// The GUI windows, drawn on top of the scene.
+        static const int LAYER_GUI = 100;
+        /// Always on top, e.g. the FPS counter.
+        static const int LAYER_OVERLAY = 200;
+
+        DrawList();
+        explicit DrawList(const sf::View& view);
+
+        void Clear(const sf::View& view);
+        void SetView(const sf::View& view);
+        /// The view set by the last SetView() or Clear().
+        inline const sf::View& GetView() const { return m_views.back(); }
+        void SetLayer(int layer);
+        inline int GetLayer() const { return m_layer; }
+        void SetDepth(float depth);
+        inline float GetDepth() const { return m_depth; }
+
+        void AddVertices(const sf::Vertex* p_vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states = sf::RenderStates::Default);
+#ifdef TSC_HAVE_VERTEX_BUFFER
+        void AddVertexBuffer(std::shared_ptr<const sf::VertexBuffer> p_buffer, size_t count, const sf::RenderStates& states = sf::RenderStates::Default);
+#endif
+        void AddDrawable(const sf::Sprite& sprite, const sf::RenderStates& states = sf::RenderStates::Default);
+        void AddDrawable(const sf::Text& text, const sf::RenderStates& states = sf::RenderStates::Default);
+        void AddCallback(std::function<void(sf::RenderTarget&)> callback, const sf::RenderStates& states = sf::RenderStates::Default);
+
+        /**
+         * Adds a copy of `drawable`, e.g. a shape, which is drawn with
+         * the given render states.
+         */
+        template<typename T>
+        void AddDrawable(const T& drawable, const sf::RenderStates& states = sf::RenderStates::Default)
+        {
+            AddOwnedDrawable(std::unique_ptr<sf::Drawable>(new T(drawable)), states);
+        }
+
+        inline bool IsEmpty() const { return m_commands.empty(); }
+        void Sort();
+        void Execute(sf::RenderTarget& target, const sf::FloatRect& viewport = sf::FloatRect(0.0f, 0.0f, 1.0f, 1.0f)) const;
+        void ExecuteLayers(sf::RenderTarget& target, int first_layer, int end_layer, const sf::FloatRect& viewport = sf::FloatRect(0.0f, 0.0f, 1.0f, 1.0f)) const;
+
+        void SetResolutionScale(float scale);
+        /// See SetResolutionScale().
+        inline float GetResolutionScale() const { return m_resolution_scale; }
+
+        static std::unique_lock<std::mutex> LockFonts();
+    private:
+        enum class CommandType { Vertices, VertexBuffer, Drawable, Text, Callback };
+
+        struct Command
+        {
+            CommandType type;
+            sf::PrimitiveType primitive;
+            sf::RenderStates states;
+            int layer;
+            float depth;
+            const void* p_texture_key; // states.texture, or the font of a text
+            uint32_t view;     // Index into m_views
+            uint32_t sequence; // Order of adding, to keep equal keys in order
+            size_t index; // Into the vector for `type`; first vertex for Vertices
+            size_t count; // Vertices for Vertices and VertexBuffer
+        };
+
+        // A draw call made by Execute(), possibly of several merged commands
+        struct Batch
+        {
+            size_t command; // Index into m_commands of the first command
+            size_t first;   // Vertices in m_batch_vertices for Vertices
+            size_t count;
+        };
+
+        Command& AddCommand(CommandType type, const sf::RenderStates& states);
+        void AddOwnedDrawable(std::unique_ptr<sf::Drawable> p_drawable, const sf::RenderStates& states);
+        bool CommandLess(uint32_t a, uint32_t b) const;
+        bool CanMerge(const Command& a, const Command& b) const;
+
+        int m_layer;
+        float m_depth;
+        float m_resolution_scale;
+        bool m_sorted;
+        std::vector<Command> m_commands;
+        std::vector<sf::Vertex> m_vertices;
+        std::vector<sf::View> m_views; // The first is the one given to Clear()
+        std::vector<std::unique_ptr<sf::Drawable>> m_drawables;
+        std::vector<sf::Text> m_texts;
+        std::vector<std::function<void(sf::RenderTarget&)>> m_callbacks;
+#ifdef TSC_HAVE_VERTEX_BUFFER
+        std::vector<std::shared_ptr<const sf::VertexBuffer>> m_buffers;
+#endif
+        std::vector<uint32_t> m_order; // Command indices in drawing order, see Sort()
+        std::vector<Batch> m_batches;
+        std::vector<sf::Vertex> m_batch_vertices;
+    };
+
+}
+
+#endif /* TSC_DRAW_LIST_HPP */
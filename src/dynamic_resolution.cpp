@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "dynamic_resolution.hpp"
+#include <algorithm>
+
+using namespace TSC;
+using namespace std;
+
+// Lowest scale used, as a blurrier picture is not worth it.
+static const float MIN_SCALE = 0.5f;
+
+// Number of frames averaged before adjusting the scale.
+static const int ADJUST_FRAMES = 15;
+
+// Adjustment per step when the frames are too slow and fast, respectively.
+static const float SCALE_STEP_DOWN = 0.1f;
+static const float SCALE_STEP_UP   = 0.05f;
+
+// Frames must be this much faster than the budget to raise the scale.
+static const float RAISE_MARGIN = 0.85f;
+
+// Otherwise, the scale is raised after this many adjustment periods within the budget.
+static const int RAISE_PERIODS = 8;
+
+/// Starts at full resolution with the given frame time budget in seconds.
+DynamicResolution::DynamicResolution(float budget)
+    : m_budget(budget),
+      m_scale(1.0f),
+      m_time_sum(0.0f),
+      m_frames(0),
+      m_periods_within_budget(0)
+{
+}
+
+/// Records the time the last frame took, in seconds.
+void DynamicResolution::Update(float frame_time)
+{
+    m_time_sum += frame_time;
+    if (++m_frames < ADJUST_FRAMES)
+        return;
+
+    float average = m_time_sum / m_frames;
+    m_time_sum = 0.0f;
+    m_frames   = 0;
+
+    if (average > m_budget) {
+        m_scale = max(MIN_SCALE, m_scale - SCALE_STEP_DOWN);
+        m_periods_within_budget = 0;
+    }
+    else if (average < m_budget * RAISE_MARGIN || ++m_periods_within_budget >= RAISE_PERIODS) {
+        m_scale = min(1.0f, m_scale + SCALE_STEP_UP);
+        m_periods_within_budget = 0;
+    }
+}
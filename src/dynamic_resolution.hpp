@@ -0,0 +1,64 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_DYNAMIC_RESOLUTION_HPP
+#define TSC_DYNAMIC_RESOLUTION_HPP
+
+namespace TSC {
+
+    /**
+     * Decides the resolution the scene is drawn at, so that frames
+     * take no longer than a given budget. Update() is fed with the
+     * time each frame took; every few frames, the scale is
+     * lowered if the frames took longer than the budget on average,
+     * and raised again if they were faster by some margin. Lowering
+     * is done in larger steps than raising, so that drops in the
+     * frame rate end quickly, while the resolution comes back without
+     * oscillating.
+     *
+     * Waiting for vsync counts as frame time, so with vsync the frames
+     * never get much faster than the refresh interval, and the budget
+     * should be a bit above it. To still get back to full resolution,
+     * the scale is also raised after a longer time within the budget;
+     * if that was too much, it is lowered again right away.
+     *
+     * The scale is relative to the stage size and stays between one
+     * half and one. The main loop draws the scene at that scale
+     * into an offscreen texture and scales it up to the stage, while
+     * the GUI is drawn at full resolution (see Application).
+     */
+    class DynamicResolution
+    {
+    public:
+        DynamicResolution(float budget);
+
+        void Update(float frame_time);
+        inline float GetScale() const { return m_scale; }
+    private:
+        float m_budget; // Seconds
+        float m_scale;
+        float m_time_sum;
+        int m_frames;
+        int m_periods_within_budget;
+    };
+
+}
+
+#endif /* TSC_DYNAMIC_RESOLUTION_HPP */
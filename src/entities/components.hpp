@@ -0,0 +1,53 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_COMPONENTS_HPP
+#define TSC_COMPONENTS_HPP
+#include <SFML/System/Vector2.hpp>
+
+/* Components of level objects. Each one is a plain struct that only
+ * holds data; the systems in systems.hpp work on them. Keep them
+ * small, as each system touches every component of its types once
+ * a frame. */
+
+namespace TSC {
+
+    /// Position of the object's top-left corner in the level, in pixels.
+    struct Position
+    {
+        sf::Vector2f pos;
+    };
+
+    /// Speed of the object in pixels per second.
+    struct Velocity
+    {
+        sf::Vector2f vel;
+    };
+
+    /// The object falls down with `acceleration` pixels per second².
+    struct Gravity
+    {
+        float acceleration;
+        float max_speed; // Terminal velocity in pixels per second
+    };
+
+}
+
+#endif /* TSC_COMPONENTS_HPP */
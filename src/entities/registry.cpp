@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "registry.hpp"
+
+using namespace TSC;
+using namespace std;
+
+const uint32_t BasicComponentPool::NO_SLOT;
+
+/**
+ * Creates a new entity without any components.
+ */
+Entity Registry::Create()
+{
+    if (!m_free.empty()) {
+        uint32_t index = m_free.back();
+        m_free.pop_back();
+        return Entity{index, m_generations[index]};
+    }
+
+    m_generations.push_back(0);
+    return Entity{static_cast<uint32_t>(m_generations.size() - 1), 0};
+}
+
+/**
+ * Removes all components of the entity and invalidates its handle.
+ * Does nothing if the entity has already been destroyed.
+ */
+void Registry::Destroy(const Entity& entity)
+{
+    if (!IsAlive(entity))
+        return;
+
+    for (unique_ptr<BasicComponentPool>& p_pool: m_pools) {
+        if (p_pool)
+            p_pool->Remove(entity.index);
+    }
+
+    m_generations[entity.index]++;
+    m_free.push_back(entity.index);
+}
+
+/**
+ * Returns false if the entity has been destroyed.
+ */
+bool Registry::IsAlive(const Entity& entity) const
+{
+    return entity.index < m_generations.size() && m_generations[entity.index] == entity.generation;
+}
+
+// Hands out a new index for each component type, see TypeIndex().
+size_t Registry::NextTypeIndex()
+{
+    static size_t next = 0;
+    return next++;
+}
@@ -0,0 +1,253 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_REGISTRY_HPP
+#define TSC_REGISTRY_HPP
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "../jobs.hpp"
+
+namespace TSC {
+
+    /**
+     * Handle of an entity in a Registry. The index of a destroyed
+     * entity is reused for later entities, but with a new generation,
+     * so that old handles can be told apart (see Registry::IsAlive()).
+     */
+    struct Entity
+    {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    inline bool operator==(const Entity& a, const Entity& b) { return a.index == b.index && a.generation == b.generation; }
+    inline bool operator!=(const Entity& a, const Entity& b) { return !(a == b); }
+
+    /* The part of a ComponentPool that does not depend on the component
+     * type, which allows the Registry to remove all components of an
+     * entity without knowing their types. */
+    class BasicComponentPool
+    {
+    public:
+        virtual ~BasicComponentPool() {}
+        virtual void Remove(uint32_t index) = 0;
+
+        inline size_t Size() const { return m_entities.size(); }
+        inline bool Has(uint32_t index) const { return index < m_slots.size() && m_slots[index] != NO_SLOT; }
+        /// Entity index of each component, in the order of the components.
+        inline const std::vector<uint32_t>& GetEntities() const { return m_entities; }
+    protected:
+        static const uint32_t NO_SLOT = 0xFFFFFFFF;
+
+        std::vector<uint32_t> m_slots;    // Component slot per entity index, or NO_SLOT
+        std::vector<uint32_t> m_entities; // Entity index per component slot
+    };
+
+    /**
+     * All components of type T, packed into one array without gaps, so
+     * that systems iterating them walk through memory linearly. Removing
+     * a component moves the last one into its place; thus adding and
+     * removing components changes the order and invalidates pointers to
+     * the components.
+     */
+    template<typename T>
+    class ComponentPool: public BasicComponentPool
+    {
+    public:
+        T& Add(uint32_t index, const T& component)
+        {
+            if (index >= m_slots.size())
+                m_slots.resize(index + 1, NO_SLOT);
+
+            if (m_slots[index] != NO_SLOT)
+                return m_components[m_slots[index]] = component;
+
+            m_slots[index] = static_cast<uint32_t>(m_components.size());
+            m_entities.push_back(index);
+            m_components.push_back(component);
+            return m_components.back();
+        }
+
+        virtual void Remove(uint32_t index)
+        {
+            if (!Has(index))
+                return;
+
+            uint32_t slot = m_slots[index];
+            uint32_t last = static_cast<uint32_t>(m_components.size() - 1);
+            if (slot != last) {
+                m_components[slot]        = std::move(m_components[last]);
+                m_entities[slot]          = m_entities[last];
+                m_slots[m_entities[slot]] = slot;
+            }
+
+            m_components.pop_back();
+            m_entities.pop_back();
+            m_slots[index] = NO_SLOT;
+        }
+
+        inline T* Get(uint32_t index) { return Has(index) ? &m_components[m_slots[index]] : nullptr; }
+        /// All components, in the order of GetEntities().
+        inline std::vector<T>& GetComponents() { return m_components; }
+    private:
+        std::vector<T> m_components;
+    };
+
+    /**
+     * Storage for the objects of a level (enemies, items, platforms, ...)
+     * in the entity-component style. An entity is nothing but a handle;
+     * its data is made up of components, which are plain structs (see
+     * components.hpp). All components of one type are kept in a single
+     * contiguous array, the ComponentPool, rather than each object
+     * being allocated separately. The behaviour lives in systems (see
+     * systems.hpp), which iterate over all entities having a specific
+     * set of components with Each() or, on all CPU cores, ParallelEach().
+     *
+     * Any type can be used as a component without registering it first.
+     * Handles remain valid until the entity is destroyed; using the
+     * handle of a destroyed entity is safe and finds no components.
+     */
+    class Registry
+    {
+    public:
+        Entity Create();
+        void Destroy(const Entity& entity);
+        bool IsAlive(const Entity& entity) const;
+        inline size_t GetEntityCount() const { return m_generations.size() - m_free.size(); }
+
+        /**
+         * Adds the component to the entity, replacing one of the same
+         * type. Throws std::runtime_error if the entity has been
+         * destroyed, as its index may belong to another entity by now.
+         */
+        template<typename T>
+        T& Add(const Entity& entity, const T& component)
+        {
+            if (!IsAlive(entity))
+                throw(std::runtime_error("Cannot add a component to a destroyed entity"));
+
+            return GetPool<T>().Add(entity.index, component);
+        }
+
+        template<typename T>
+        void Remove(const Entity& entity)
+        {
+            if (IsAlive(entity))
+                GetPool<T>().Remove(entity.index);
+        }
+
+        /// Returns the entity's component of type T, or nullptr if it has none.
+        template<typename T>
+        T* Get(const Entity& entity)
+        {
+            return IsAlive(entity) ? GetPool<T>().Get(entity.index) : nullptr;
+        }
+
+        template<typename T>
+        ComponentPool<T>& GetPool()
+        {
+            size_t type = TypeIndex<T>();
+            if (type >= m_pools.size())
+                m_pools.resize(type + 1);
+            if (!m_pools[type])
+                m_pools[type].reset(new ComponentPool<T>());
+
+            return static_cast<ComponentPool<T>&>(*m_pools[type]);
+        }
+
+        /**
+         * Calls `func(entity, t)` for each entity having a component of
+         * type T, in the order of T's pool. `func` must not add or
+         * remove components of type T, nor destroy entities.
+         */
+        template<typename T, typename Func>
+        void Each(Func func)
+        {
+            ComponentPool<T>& pool = GetPool<T>();
+            std::vector<T>& components = pool.GetComponents();
+            const std::vector<uint32_t>& entities = pool.GetEntities();
+
+            for (size_t i=0; i < components.size(); i++)
+                func(Entity{entities[i], m_generations[entities[i]]}, components[i]);
+        }
+
+        /**
+         * Calls `func(entity, t, u)` for each entity having components
+         * of both type T and U. T's pool is iterated and U's is looked
+         * up for each entity, so T should be the rarer component.
+         */
+        template<typename T, typename U, typename Func>
+        void Each(Func func)
+        {
+            ComponentPool<T>& pool   = GetPool<T>();
+            ComponentPool<U>& others = GetPool<U>();
+            std::vector<T>& components = pool.GetComponents();
+            const std::vector<uint32_t>& entities = pool.GetEntities();
+
+            for (size_t i=0; i < components.size(); i++) {
+                U* p_other = others.Get(entities[i]);
+                if (p_other)
+                    func(Entity{entities[i], m_generations[entities[i]]}, components[i], *p_other);
+            }
+        }
+
+        /**
+         * Like Each() with two component types, but spreads the
+         * entities over the job system (see Jobs) in batches of up
+         * to `batch` entities. `func` is called from several threads
+         * at once, so it must only modify the components passed to it.
+         */
+        template<typename T, typename U, typename Func>
+        void ParallelEach(const char* name, size_t batch, Func func)
+        {
+            ComponentPool<T>& pool   = GetPool<T>();
+            ComponentPool<U>& others = GetPool<U>();
+            std::vector<T>& components = pool.GetComponents();
+            const std::vector<uint32_t>& entities = pool.GetEntities();
+
+            Jobs::ParallelFor(name, components.size(), batch, [&](size_t first, size_t end) {
+                    for (size_t i=first; i < end; i++) {
+                        U* p_other = others.Get(entities[i]);
+                        if (p_other)
+                            func(Entity{entities[i], m_generations[entities[i]]}, components[i], *p_other);
+                    }
+                });
+        }
+    private:
+        static size_t NextTypeIndex();
+
+        template<typename T>
+        static size_t TypeIndex()
+        {
+            static const size_t index = NextTypeIndex();
+            return index;
+        }
+
+        std::vector<uint32_t> m_generations; // Current generation per entity index
+        std::vector<uint32_t> m_free;        // Indices of destroyed entities
+        std::vector<std::unique_ptr<BasicComponentPool>> m_pools; // By TypeIndex()
+    };
+
+}
+
+#endif /* TSC_REGISTRY_HPP */
@@ -0,0 +1,51 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "systems.hpp"
+#include "components.hpp"
+#include "registry.hpp"
+#include <algorithm>
+
+using namespace TSC;
+using namespace std;
+
+/* Number of entities per job. Each system does very little work per
+ * entity, so smaller batches would mostly measure the job overhead. */
+static const size_t ENTITY_BATCH = 4096;
+
+/**
+ * Accelerates all entities with Gravity and Velocity downwards.
+ */
+void Systems::ApplyGravity(Registry& registry, float elapsed)
+{
+    registry.ParallelEach<Gravity, Velocity>("Systems::ApplyGravity", ENTITY_BATCH, [elapsed](Entity, Gravity& gravity, Velocity& velocity) {
+            velocity.vel.y = min(velocity.vel.y + gravity.acceleration * elapsed, gravity.max_speed);
+        });
+}
+
+/**
+ * Moves all entities with Velocity and Position.
+ */
+void Systems::Move(Registry& registry, float elapsed)
+{
+    registry.ParallelEach<Velocity, Position>("Systems::Move", ENTITY_BATCH, [elapsed](Entity, Velocity& velocity, Position& position) {
+            position.pos += velocity.vel * elapsed;
+        });
+}
@@ -0,0 +1,341 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "event_recording.hpp"
+#include "util.hpp"
+#include <SFML/Window.hpp>
+#include <cstring>
+#include <stdexcept>
+
+using namespace TSC;
+using namespace std;
+
+static const char RECORDING_MAGIC[] = "TSCR";
+static const uint8_t RECORDING_VERSION = 1;
+static const uint8_t RECORD_END = 0xFF;
+
+/**
+ * Creates the recording file at `path`, overwriting it if it exists.
+ * Throws std::runtime_error if the file cannot be opened.
+ */
+EventRecorder::EventRecorder(const string& path)
+    : m_file(path, ios::out | ios::binary | ios::trunc),
+      m_last_frame(0),
+      m_finished(false)
+{
+    if (!m_file)
+        throw(runtime_error(format("Cannot open '%s' for recording events", path.c_str())));
+
+    m_file.write(RECORDING_MAGIC, 4);
+    m_file.put(static_cast<char>(RECORDING_VERSION));
+}
+
+EventRecorder::~EventRecorder()
+{
+    if (!m_finished)
+        Finish(m_last_frame);
+}
+
+/// Appends `event`, received in main loop iteration `frame`, to the file.
+void EventRecorder::Record(uint64_t frame, const sf::Event& event)
+{
+    m_record.clear();
+    PutFrame(frame);
+    m_record.push_back(static_cast<char>(event.type));
+
+    switch (event.type) {
+    case sf::Event::Resized:
+        PutUnsigned(event.size.width);
+        PutUnsigned(event.size.height);
+        break;
+    case sf::Event::TextEntered:
+        PutUnsigned(event.text.unicode);
+        break;
+    case sf::Event::KeyPressed:
+    case sf::Event::KeyReleased:
+        PutSigned(event.key.code);
+        m_record.push_back(static_cast<char>((event.key.alt     ? 1 : 0) |
+                                             (event.key.control ? 2 : 0) |
+                                             (event.key.shift   ? 4 : 0) |
+                                             (event.key.system  ? 8 : 0)));
+        break;
+    case sf::Event::MouseWheelMoved:
+        PutSigned(event.mouseWheel.delta);
+        PutSigned(event.mouseWheel.x);
+        PutSigned(event.mouseWheel.y);
+        break;
+    case sf::Event::MouseWheelScrolled:
+        PutUnsigned(event.mouseWheelScroll.wheel);
+        PutFloat(event.mouseWheelScroll.delta);
+        PutSigned(event.mouseWheelScroll.x);
+        PutSigned(event.mouseWheelScroll.y);
+        break;
+    case sf::Event::MouseButtonPressed:
+    case sf::Event::MouseButtonReleased:
+        PutUnsigned(event.mouseButton.button);
+        PutSigned(event.mouseButton.x);
+        PutSigned(event.mouseButton.y);
+        break;
+    case sf::Event::MouseMoved:
+        PutSigned(event.mouseMove.x);
+        PutSigned(event.mouseMove.y);
+        break;
+    case sf::Event::JoystickButtonPressed:
+    case sf::Event::JoystickButtonReleased:
+        PutUnsigned(event.joystickButton.joystickId);
+        PutUnsigned(event.joystickButton.button);
+        break;
+    case sf::Event::JoystickMoved:
+        PutUnsigned(event.joystickMove.joystickId);
+        PutUnsigned(event.joystickMove.axis);
+        PutFloat(event.joystickMove.position);
+        break;
+    case sf::Event::JoystickConnected:
+    case sf::Event::JoystickDisconnected:
+        PutUnsigned(event.joystickConnect.joystickId);
+        break;
+    case sf::Event::TouchBegan:
+    case sf::Event::TouchMoved:
+    case sf::Event::TouchEnded:
+        PutUnsigned(event.touch.finger);
+        PutSigned(event.touch.x);
+        PutSigned(event.touch.y);
+        break;
+    case sf::Event::SensorChanged:
+        PutUnsigned(event.sensor.type);
+        PutFloat(event.sensor.x);
+        PutFloat(event.sensor.y);
+        PutFloat(event.sensor.z);
+        break;
+    default: // Events without members
+        break;
+    }
+
+    m_file.write(m_record.data(), m_record.size());
+}
+
+/// Writes the end marker. `frame` is the last frame of the session.
+void EventRecorder::Finish(uint64_t frame)
+{
+    m_record.clear();
+    PutFrame(frame);
+    m_record.push_back(static_cast<char>(RECORD_END));
+    m_file.write(m_record.data(), m_record.size());
+    m_file.flush();
+
+    if (!m_file)
+        warn("Failed to write the event recording");
+
+    m_finished = true;
+}
+
+void EventRecorder::PutFrame(uint64_t frame)
+{
+    PutUnsigned(frame - m_last_frame);
+    m_last_frame = frame;
+}
+
+void EventRecorder::PutUnsigned(uint64_t value)
+{
+    while (value >= 0x80) {
+        m_record.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    m_record.push_back(static_cast<char>(value));
+}
+
+void EventRecorder::PutSigned(int64_t value)
+{
+    // Zigzag encoding keeps small negative numbers small
+    PutUnsigned((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void EventRecorder::PutFloat(float value)
+{
+    uint32_t bits = 0;
+    memcpy(&bits, &value, 4);
+    for (int i=0; i < 4; i++)
+        m_record.push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+}
+
+/**
+ * Loads the recording at `path` completely into memory. Throws
+ * std::runtime_error if it cannot be read or is not a recording.
+ */
+EventPlayer::EventPlayer(const string& path)
+    : m_pos(5),
+      m_next_frame(0),
+      m_at_end(false)
+{
+    ifstream file(path, ios::in | ios::binary | ios::ate);
+    if (!file)
+        throw(runtime_error(format("Cannot open event recording '%s'", path.c_str())));
+
+    streamsize size = file.tellg();
+    m_data.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(m_data.data(), size))
+        throw(runtime_error(format("Cannot read event recording '%s'", path.c_str())));
+
+    if (m_data.size() < 5 || memcmp(m_data.data(), RECORDING_MAGIC, 4) != 0 || static_cast<uint8_t>(m_data[4]) != RECORDING_VERSION)
+        throw(runtime_error(format("'%s' is not an event recording of a supported version", path.c_str())));
+
+    ReadFrame();
+}
+
+/**
+ * Fills `event` with the next event recorded in main loop iteration
+ * `frame`. Call this repeatedly until it returns false, just like
+ * sf::Window::pollEvent().
+ */
+bool EventPlayer::Poll(uint64_t frame, sf::Event& event)
+{
+    if (m_at_end || m_next_frame != frame)
+        return false;
+
+    event.type = static_cast<sf::Event::EventType>(GetByte());
+
+    switch (event.type) {
+    case sf::Event::Resized:
+        event.size.width  = static_cast<unsigned int>(GetUnsigned());
+        event.size.height = static_cast<unsigned int>(GetUnsigned());
+        break;
+    case sf::Event::TextEntered:
+        event.text.unicode = static_cast<sf::Uint32>(GetUnsigned());
+        break;
+    case sf::Event::KeyPressed:
+    case sf::Event::KeyReleased: {
+        event.key.code = static_cast<sf::Keyboard::Key>(GetSigned());
+        uint8_t mods = GetByte();
+        event.key.alt     = (mods & 1) != 0;
+        event.key.control = (mods & 2) != 0;
+        event.key.shift   = (mods & 4) != 0;
+        event.key.system  = (mods & 8) != 0;
+    } break;
+    case sf::Event::MouseWheelMoved:
+        event.mouseWheel.delta = static_cast<int>(GetSigned());
+        event.mouseWheel.x     = static_cast<int>(GetSigned());
+        event.mouseWheel.y     = static_cast<int>(GetSigned());
+        break;
+    case sf::Event::MouseWheelScrolled:
+        event.mouseWheelScroll.wheel = static_cast<sf::Mouse::Wheel>(GetUnsigned());
+        event.mouseWheelScroll.delta = GetFloat();
+        event.mouseWheelScroll.x     = static_cast<int>(GetSigned());
+        event.mouseWheelScroll.y     = static_cast<int>(GetSigned());
+        break;
+    case sf::Event::MouseButtonPressed:
+    case sf::Event::MouseButtonReleased:
+        event.mouseButton.button = static_cast<sf::Mouse::Button>(GetUnsigned());
+        event.mouseButton.x      = static_cast<int>(GetSigned());
+        event.mouseButton.y      = static_cast<int>(GetSigned());
+        break;
+    case sf::Event::MouseMoved:
+        event.mouseMove.x = static_cast<int>(GetSigned());
+        event.mouseMove.y = static_cast<int>(GetSigned());
+        break;
+    case sf::Event::JoystickButtonPressed:
+    case sf::Event::JoystickButtonReleased:
+        event.joystickButton.joystickId = static_cast<unsigned int>(GetUnsigned());
+        event.joystickButton.button     = static_cast<unsigned int>(GetUnsigned());
+        break;
+    case sf::Event::JoystickMoved:
+        event.joystickMove.joystickId = static_cast<unsigned int>(GetUnsigned());
+        event.joystickMove.axis       = static_cast<sf::Joystick::Axis>(GetUnsigned());
+        event.joystickMove.position   = GetFloat();
+        break;
+    case sf::Event::JoystickConnected:
+    case sf::Event::JoystickDisconnected:
+        event.joystickConnect.joystickId = static_cast<unsigned int>(GetUnsigned());
+        break;
+    case sf::Event::TouchBegan:
+    case sf::Event::TouchMoved:
+    case sf::Event::TouchEnded:
+        event.touch.finger = static_cast<unsigned int>(GetUnsigned());
+        event.touch.x      = static_cast<int>(GetSigned());
+        event.touch.y      = static_cast<int>(GetSigned());
+        break;
+    case sf::Event::SensorChanged:
+        event.sensor.type = static_cast<sf::Sensor::Type>(GetUnsigned());
+        event.sensor.x    = GetFloat();
+        event.sensor.y    = GetFloat();
+        event.sensor.z    = GetFloat();
+        break;
+    default: // Events without members
+        break;
+    }
+
+    ReadFrame();
+    return true;
+}
+
+/// Returns true once the replay has reached the frame the recording ended in.
+bool EventPlayer::HasFinished(uint64_t frame) const
+{
+    return m_at_end && frame >= m_next_frame;
+}
+
+// Reads the frame of the next record and checks for the end marker.
+void EventPlayer::ReadFrame()
+{
+    m_next_frame += GetUnsigned();
+
+    if (m_pos < m_data.size() && static_cast<uint8_t>(m_data[m_pos]) == RECORD_END)
+        m_at_end = true;
+}
+
+uint64_t EventPlayer::GetUnsigned()
+{
+    uint64_t value = 0;
+    int shift = 0;
+    uint8_t byte = 0;
+
+    do {
+        byte = GetByte();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while ((byte & 0x80) && shift < 64);
+
+    return value;
+}
+
+int64_t EventPlayer::GetSigned()
+{
+    uint64_t value = GetUnsigned();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+float EventPlayer::GetFloat()
+{
+    uint32_t bits = 0;
+    for (int i=0; i < 4; i++)
+        bits |= static_cast<uint32_t>(GetByte()) << (8 * i);
+
+    float value = 0.0f;
+    memcpy(&value, &bits, 4);
+    return value;
+}
+
+uint8_t EventPlayer::GetByte()
+{
+    if (m_pos >= m_data.size())
+        throw(runtime_error("Event recording is truncated"));
+
+    return static_cast<uint8_t>(m_data[m_pos++]);
+}
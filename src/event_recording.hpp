@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_EVENT_RECORDING_HPP
+#define TSC_EVENT_RECORDING_HPP
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// forward-declare
+namespace sf {
+    class Event;
+}
+
+namespace TSC {
+
+    /**
+     * Writes the events received by the main loop to a file, so that
+     * the session can be replayed later with EventPlayer. This makes
+     * performance measurements reproducible: record a session once,
+     * then replay it before and after a change.
+     *
+     * The file starts with the magic bytes "TSCR" and a version byte.
+     * Each event is then stored as the number of frames since the
+     * previous event, the event type and the members of the event
+     * that are meaningful for that type. Integers are stored as
+     * variable-length quantities (7 bits per byte, least significant
+     * group first; signed integers zigzag-encoded), floats as 4 bytes
+     * little-endian. A record of type 0xFF marks the frame the
+     * recording ended in.
+     */
+    class EventRecorder
+    {
+    public:
+        EventRecorder(const std::string& path);
+        ~EventRecorder();
+
+        void Record(uint64_t frame, const sf::Event& event);
+        void Finish(uint64_t frame);
+    private:
+        void PutFrame(uint64_t frame);
+        void PutUnsigned(uint64_t value);
+        void PutSigned(int64_t value);
+        void PutFloat(float value);
+
+        std::ofstream m_file;
+        std::vector<char> m_record;
+        uint64_t m_last_frame;
+        bool m_finished;
+    };
+
+    /**
+     * Reads a file written by EventRecorder and hands out the
+     * recorded events in the frames they were originally received.
+     */
+    class EventPlayer
+    {
+    public:
+        EventPlayer(const std::string& path);
+
+        bool Poll(uint64_t frame, sf::Event& event);
+        bool HasFinished(uint64_t frame) const;
+    private:
+        void ReadFrame();
+        uint64_t GetUnsigned();
+        int64_t GetSigned();
+        float GetFloat();
+        uint8_t GetByte();
+
+        std::vector<char> m_data;
+        size_t m_pos;
+        uint64_t m_next_frame; // Frame of the next record
+        bool m_at_end;         // Next record is the end marker
+    };
+
+}
+
+#endif /* TSC_EVENT_RECORDING_HPP */
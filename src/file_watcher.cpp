@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "file_watcher.hpp"
+#include "util.hpp"
+#include <algorithm>
+
+#ifdef __linux
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+using namespace TSC;
+using namespace Pathie;
+using namespace std;
+
+#ifdef __linux
+
+/* A file counts as changed once it has been written and closed, or
+ * moved into place (which is how many editors save). Creating a
+ * directory is watched to start watching it as well. */
+static const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+
+FileWatcher::FileWatcher()
+{
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0)
+        warn(format("Cannot watch files for changes: %s", strerror(errno)));
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+/**
+ * Watches the directory `path` and all of its subdirectories. Does
+ * nothing if the directory does not exist.
+ */
+void FileWatcher::AddDirectory(const Path& path)
+{
+    if (m_fd < 0 || !path.is_directory())
+        return;
+
+    int wd = inotify_add_watch(m_fd, path.utf8_str().c_str(), WATCH_MASK);
+    if (wd < 0) {
+        warn(format("Cannot watch '%s' for changes: %s", path.utf8_str().c_str(), strerror(errno)));
+        return;
+    }
+
+    m_watches[wd] = path;
+
+    for (const Path& child: path.children()) {
+        if (child.is_directory())
+            AddDirectory(child);
+    }
+}
+
+/**
+ * Appends the files that have changed since the last call to
+ * `changed`, each one only once. Never blocks.
+ *
+ * \returns true if any file has changed.
+ */
+bool FileWatcher::Poll(vector<Path>& changed)
+{
+    if (m_fd < 0)
+        return false;
+
+    size_t first = changed.size();
+    alignas(struct inotify_event) char buf[4096];
+    ssize_t len = 0;
+
+    while ((len = read(m_fd, buf, sizeof(buf))) > 0) {
+        for (char* p = buf; p < buf + len; p += sizeof(struct inotify_event) + reinterpret_cast<struct inotify_event*>(p)->len) {
+            const struct inotify_event* p_event = reinterpret_cast<struct inotify_event*>(p);
+
+            if (p_event->mask & IN_Q_OVERFLOW) {
+                warn("Too many files changed at once, some changes were missed");
+                continue;
+            }
+
+            if (p_event->mask & IN_IGNORED) { // Directory was deleted
+                m_watches.erase(p_event->wd);
+                continue;
+            }
+
+            auto iter = m_watches.find(p_event->wd);
+            if (iter == m_watches.end() || p_event->len == 0)
+                continue;
+
+            Path path = iter->second / p_event->name;
+            if (p_event->mask & IN_ISDIR) {
+                if (p_event->mask & (IN_CREATE | IN_MOVED_TO))
+                    AddDirectory(path);
+            }
+            else if (p_event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                if (find(changed.begin() + first, changed.end(), path) == changed.end())
+                    changed.push_back(path);
+            }
+        }
+    }
+
+    return changed.size() > first;
+}
+
+#else
+
+FileWatcher::FileWatcher()
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+void FileWatcher::AddDirectory(const Path&)
+{
+}
+
+bool FileWatcher::Poll(vector<Path>&)
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_FILE_WATCHER_HPP
+#define TSC_FILE_WATCHER_HPP
+#include <map>
+#include <vector>
+#include <pathie/path.hpp>
+
+namespace TSC {
+
+    /**
+     * Watches directories for files being changed, so that levels,
+     * tilesets and textures can be reloaded while the game is running
+     * (see Scene::ReloadFile()). Directories are watched recursively,
+     * including subdirectories created later on.
+     *
+     * This uses inotify and thus only works on Linux. On other systems,
+     * adding directories does nothing and Poll() never reports changes.
+     */
+    class FileWatcher
+    {
+    public:
+        FileWatcher();
+        ~FileWatcher();
+
+        void AddDirectory(const Pathie::Path& path);
+        bool Poll(std::vector<Pathie::Path>& changed);
+    private:
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+#ifdef __linux
+        int m_fd; // inotify instance
+        std::map<int, Pathie::Path> m_watches; // Directory per watch descriptor
+#endif
+    };
+
+}
+
+#endif /* TSC_FILE_WATCHER_HPP */
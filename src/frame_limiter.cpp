@@ -0,0 +1,65 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "frame_limiter.hpp"
+#include <thread>
+
+using namespace TSC;
+using namespace std;
+
+/* Time before the next frame that is not slept, but spent polling the
+ * clock, to make up for the inaccuracy of sf::sleep(). */
+static const sf::Time SPIN_TIME = sf::milliseconds(2);
+
+FrameLimiter::FrameLimiter()
+{
+}
+
+/**
+ * Waits until the next frame is due if the frame rate is capped at
+ * `fps` frames per second. If `fps` is zero or less, the frame rate is
+ * not capped and this returns right away. The cap may change from
+ * frame to frame.
+ */
+void FrameLimiter::Wait(int fps)
+{
+    sf::Time now = m_clock.getElapsedTime();
+    if (fps <= 0) {
+        m_next_frame = now;
+        return;
+    }
+
+    sf::Time interval = sf::microseconds(1000000 / fps);
+    m_next_frame += interval;
+
+    // Behind schedule; start over from now
+    if (now >= m_next_frame) {
+        if (now - m_next_frame > interval)
+            m_next_frame = now;
+        return;
+    }
+
+    sf::Time remaining = m_next_frame - now;
+    if (remaining > SPIN_TIME)
+        sf::sleep(remaining - SPIN_TIME);
+
+    while (m_clock.getElapsedTime() < m_next_frame)
+        this_thread::yield();
+}
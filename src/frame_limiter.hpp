@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_FRAME_LIMITER_HPP
+#define TSC_FRAME_LIMITER_HPP
+#include <SFML/System.hpp>
+
+namespace TSC {
+
+    /**
+     * Caps the frame rate of the main loop. Wait() is called once at
+     * the end of each frame and returns when it is time for the next
+     * one. Most of the waiting is done with sf::sleep(), which is
+     * cheap, but may oversleep by a millisecond or more depending on
+     * the OS scheduler. The last bit is therefore waited for by
+     * polling the clock, which is exact.
+     *
+     * The time of the next frame is advanced by one interval each
+     * frame rather than counted from the end of the wait, so that
+     * small delays do not add up and the average frame rate matches
+     * the target. If a frame took longer than an interval, the
+     * schedule starts over instead of rushing the following frames.
+     */
+    class FrameLimiter
+    {
+    public:
+        FrameLimiter();
+
+        void Wait(int fps);
+    private:
+        sf::Clock m_clock;
+        sf::Time m_next_frame; // On m_clock
+    };
+
+}
+
+#endif /* TSC_FRAME_LIMITER_HPP */
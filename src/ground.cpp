@@ -19,7 +19,10 @@
  ******************************************************************************/
 
 #include "ground.hpp"
+#include "jobs.hpp"
 #include "pathmap.hpp"
+#include "settings.hpp"
+#include "texture_cache.hpp"
 #include "util.hpp"
 #include "xerces_helpers.hpp"
 #include <pathie/path.hpp>
@@ -28,6 +31,12 @@
 #include <xercesc/sax2/SAX2XMLReader.hpp>
 #include <xercesc/sax2/Attributes.hpp>
 #include <xercesc/sax2/XMLReaderFactory.hpp>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <stdexcept>
 #include <vector>
 
@@ -36,12 +45,47 @@ using namespace std;
 using Pathie::Path;
 using namespace xercesc;
 
+// Definitions for the constants passed by reference, e.g. to vector::assign()
+const int Ground::CHUNK_SIZE;
+const int Ground::NO_TILE;
+const uint16_t Ground::EMPTY_CELL;
+
+/* Binary tileset metadata as generated by `tscproc -B'. See
+ * tscproc/genbin.hpp for a description of the format. */
+static const char TILESET_BIN_MAGIC[] = "TSCT";
+static const uint32_t TILESET_BIN_VERSION = 2;
+static const size_t TILESET_BIN_HEADER_SIZE = 40;
+
+/* Fragment shader drawing a dense chunk as a single quad, whose
+ * texture coordinates run from (0|0) to (1|1). `tilemap' has one
+ * texel per grid cell with the tile ID in the red (low byte) and
+ * green (high byte) channels, and zero alpha for empty cells. */
+static const char TILEMAP_FRAGMENT_SHADER[] = R"(#version 110
+uniform sampler2D tilemap;
+uniform sampler2D tileset;
+uniform vec2 mapsize;     // Chunk size in tiles
+uniform vec2 tilesetsize; // Tileset size in tiles
+
+void main()
+{
+    vec2 cell  = gl_TexCoord[0].xy * mapsize;
+    vec4 entry = texture2D(tilemap, (floor(cell) + 0.5) / mapsize);
+    if (entry.a < 0.5)
+        discard;
+
+    float id  = floor(entry.r * 255.0 + 0.5) + floor(entry.g * 255.0 + 0.5) * 256.0;
+    vec2 tile = vec2(mod(id, tilesetsize.x), floor(id / tilesetsize.x));
+    gl_FragColor = gl_Color * texture2D(tileset, (tile + fract(cell)) / tilesetsize);
+}
+)";
+
 namespace {
     // Tilset XML settings handler.
     class TilesetSettingsHandler: public xercesc::DefaultHandler
     {
     public:
         TilesetSettingsHandler()
+            : rows(0), cols(0)
             {
             }
         void startElement(const XMLCh* const,
@@ -52,13 +96,24 @@ namespace {
                 string localname(X2U(xlocalname));
                 m_chars.clear();
 
-                if (localname == "colrect") {
+                if (localname == "tile") {
+                    tiles.push_back(ColrectRange{static_cast<unsigned int>(bboxes.size()), 0});
+                }
+                else if (localname == "colrect") {
                     string x = X2U(attrs.getValue(U2X("x")));
                     string y = X2U(attrs.getValue(U2X("y")));
                     string w = X2U(attrs.getValue(U2X("width")));
                     string h = X2U(attrs.getValue(U2X("height")));
 
+                    // Older files mark tiles without collision with a -1 rectangle.
+                    if (stoi(x) < 0 || stoi(y) < 0)
+                        return;
+
+                    if (tiles.empty()) // <colrect> outside <tile>
+                        tiles.push_back(ColrectRange{0, 0});
+
                     bboxes.emplace_back(stoi(x), stoi(y), stoi(w), stoi(h));
+                    tiles.back().count++;
                 }
             }
 
@@ -85,6 +140,7 @@ namespace {
         int rows;
         int cols;
         vector<sf::FloatRect> bboxes;
+        vector<ColrectRange> tiles;
     private:
         string m_chars;
     };
@@ -96,7 +152,14 @@ namespace {
  */
 Ground::Ground()
     : m_rows(0),
-      m_cols(0)
+      m_cols(0),
+      m_tilewidth(0),
+      m_tileheight(0),
+      m_chunk_cols(0),
+      m_chunk_rows(0),
+      m_chunk_grid_width(0),
+      m_built_bytes(0),
+      mp_tileset(nullptr)
 {
     //
 }
@@ -119,17 +182,54 @@ Ground::Ground()
  */
 Ground::Ground(const string& tileset, const vector<Field>& fields)
     : m_rows(0),
-      m_cols(0)
+      m_cols(0),
+      m_tilewidth(0),
+      m_tileheight(0),
+      m_chunk_cols(0),
+      m_chunk_rows(0),
+      m_chunk_grid_width(0),
+      m_built_bytes(0),
+      mp_tileset(nullptr)
 {
     reset(tileset, fields);
 }
 
+/**
+ * Like the above, but takes over the list of fields. Its memory is
+ * released once the fields have been packed into the chunks.
+ */
+Ground::Ground(const string& tileset, vector<Field>&& fields)
+    : m_rows(0),
+      m_cols(0),
+      m_tilewidth(0),
+      m_tileheight(0),
+      m_chunk_cols(0),
+      m_chunk_rows(0),
+      m_chunk_grid_width(0),
+      m_built_bytes(0),
+      mp_tileset(nullptr)
+{
+    reset(tileset, std::move(fields));
+}
+
 /**
  * If you used the default constructor, use this function to get the
  * Ground object ready. It takes the same parameters as the parameterised
  * constructor.
  */
 void Ground::reset(const string& tileset, const vector<Field>& fields)
+{
+    LoadTilesetMetadata(tileset);
+    LoadTilesetTexture();
+    SplitIntoChunks(fields.data(), fields.size());
+}
+
+/**
+ * First part of reset(): checks that the tileset exists and loads its
+ * metadata. This does not access the graphics card, so multiple grounds
+ * may do this concurrently. Must be followed by LoadTilesetTexture().
+ */
+void Ground::LoadTilesetMetadata(const string& tileset)
 {
     Path tileset_path = Pathmap::GetPixmapsPath() / "tilesets" / tileset;
     if (!tileset_path.exists())
@@ -140,22 +240,129 @@ void Ground::reset(const string& tileset, const vector<Field>& fields)
     if (!settings_path.exists())
         throw(runtime_error(string("Tileset settings file '") + settings_path.utf8_str() + "' not found"));
 
-    LoadSettingsFile(settings_path.utf8_str());
+    // Prefer the binary metadata, but only if it is up to date.
+    Path binary_path = tileset_path.sub_ext(".tsb");
+    if (!binary_path.exists() || !LoadBinarySettingsFile(binary_path, tileset_path, settings_path))
+        LoadSettingsFile(settings_path.utf8_str());
 
-    sf::Image img;
-    img.loadFromFile(path2sf(tileset_path));
+    m_tileset = tileset;
+    mp_tileset = nullptr;
+}
 
-    // SFML docs say that 512px are minimum of quite old cards,
-    // and say that newer cards support 8192px or more.
-    unsigned int maxedge = sf::Texture::getMaximumSize();
-    if (img.getSize().x > maxedge)
-        throw(runtime_error(format("Tileset '%s' is too large for your graphics card, which only supports up to %d pixels for an edge!", tileset_path.utf8_str(), maxedge)));
-    if (img.getSize().y > maxedge)
-        throw(runtime_error(format("Tileset '%s' is too large for your graphics card, which only supports up to %d pixels for an edge!", tileset_path.utf8_str(), maxedge)));
+/**
+ * Second part of reset(): retrieves the texture of the tileset passed
+ * to LoadTilesetMetadata() from the TextureCache. Call this from the
+ * main thread only. Afterwards, the fields can be set with SetFields().
+ */
+void Ground::LoadTilesetTexture()
+{
+    /* The tileset texture is shared with all other grounds using the
+     * same tileset. If a scene preloaded it, this does not block. */
+    mp_tileset = &TextureCache::Get(string("tilesets/") + m_tileset);
+    if (mp_tileset->getSize().x == 0 || mp_tileset->getSize().y == 0) {
+        Path tileset_path = Pathmap::GetPixmapsPath() / "tilesets" / m_tileset;
+        mp_tileset = nullptr;
+        throw(runtime_error(format("Tileset '%s' could not be loaded. Note that your graphics card only supports up to %d pixels for an edge.", tileset_path.utf8_str().c_str(), sf::Texture::getMaximumSize())));
+    }
+
+    // The tileset dimensions are required to be an exact multiple.
+    m_tilewidth  = mp_tileset->getSize().x / m_cols;
+    m_tileheight = mp_tileset->getSize().y / m_rows;
+
+    // Texture coordinates of each tile's top-left corner, so that
+    // building vertices needs no division per field.
+    m_tile_texcoords.resize(m_rows * m_cols);
+    for (int i=0; i < m_rows * m_cols; i++)
+        m_tile_texcoords[i] = sf::Vector2f((i % m_cols) * m_tilewidth, (i / m_cols) * m_tileheight);
+}
+
+/**
+ * Variant of reset() that takes over the list of fields, see the
+ * constructor.
+ */
+void Ground::reset(const string& tileset, vector<Field>&& fields)
+{
+    vector<Field> owned_fields(std::move(fields));
+    reset(tileset, owned_fields);
+}
+
+/**
+ * Replaces the fields of a Ground that has already been set up with
+ * reset() or the parameterised constructor. The tileset is kept. All
+ * chunks are released; see BuildChunk().
+ */
+void Ground::SetFields(const vector<Field>& fields)
+{
+    if (!mp_tileset)
+        throw(runtime_error("Ground::SetFields() called before a tileset was set"));
 
-    m_tileset.loadFromImage(img);
+    SplitIntoChunks(fields.data(), fields.size());
+}
+
+/**
+ * Variant of SetFields() for fields that are not in a std::vector,
+ * e.g. because they were allocated from an Arena.
+ */
+void Ground::SetFields(const Field* p_fields, size_t count)
+{
+    if (!mp_tileset)
+        throw(runtime_error("Ground::SetFields() called before a tileset was set"));
 
-    ReadVertices(fields, img);
+    SplitIntoChunks(p_fields, count);
+}
+
+/// Variant of SetFields() that takes over the list of fields.
+void Ground::SetFields(vector<Field>&& fields)
+{
+    vector<Field> owned_fields(std::move(fields));
+    SetFields(owned_fields);
+}
+
+/**
+ * Loads the metadata and texture of the tileset again, e.g. after
+ * the files have been changed on disk, and sets up the chunks anew
+ * with the current fields. The texture itself has to be reloaded in
+ * the TextureCache first (see TextureCache::Reload()). All chunks
+ * are released; they need to be built again.
+ */
+void Ground::ReloadTileset()
+{
+    if (!mp_tileset)
+        throw(runtime_error("Ground::ReloadTileset() called before a tileset was set"));
+
+    // Field positions depend on the old tile size, so get them first
+    vector<Field> fields = CollectFields();
+
+    LoadTilesetMetadata(m_tileset);
+    LoadTilesetTexture();
+    SplitIntoChunks(fields.data(), fields.size());
+}
+
+// Returns the fields of all chunks, in no particular order.
+vector<Field> Ground::CollectFields() const
+{
+    vector<Field> fields;
+
+    for (const Chunk& chunk: m_chunks) {
+        for (size_t i=0; i < chunk.tiles.size(); i++) {
+            if (chunk.tiles[i] == EMPTY_CELL)
+                continue;
+
+            int col = chunk.first_col + static_cast<int>(i) % m_chunk_cols;
+            int row = chunk.first_row + static_cast<int>(i) / m_chunk_cols;
+            fields.emplace_back(col * m_tilewidth, row * m_tileheight, chunk.tiles[i]);
+        }
+
+        for (const GridField& field: chunk.grid_fields)
+            fields.emplace_back(field.col * m_tilewidth, field.row * m_tileheight, field.tileid);
+
+        for (const Field& field: chunk.free_fields) {
+            if (field.tileid != NO_TILE)
+                fields.push_back(field);
+        }
+    }
+
+    return fields;
 }
 
 void Ground::LoadSettingsFile(const string& path)
@@ -172,52 +379,1013 @@ void Ground::LoadSettingsFile(const string& path)
     m_rows = handler.rows;
     m_cols = handler.cols;
     m_colrects.swap(handler.bboxes);
+    m_tile_colrects.swap(handler.tiles);
 
     if (m_rows <= 0)
         throw(runtime_error("No rows found in the tileset metadata"));
-    if (m_rows <= 0)
+    if (m_cols <= 0)
         throw(runtime_error("No columns found in the tileset metadata"));
 }
 
+// Reads a little-endian 32-bit integer from `p'.
+static uint32_t read_le32(const char* p)
+{
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    return u[0] | (u[1] << 8) | (u[2] << 16) | (static_cast<uint32_t>(u[3]) << 24);
+}
+
+// Reads a little-endian 64-bit integer from `p'.
+static uint64_t read_le64(const char* p)
+{
+    return read_le32(p) | (static_cast<uint64_t>(read_le32(p + 4)) << 32);
+}
+
+/**
+ * Loads the binary tileset metadata at `path', which is read with
+ * a single read call. The file is only accepted if the checksums
+ * recorded in it match the tileset PNG and XML files, i.e. if it
+ * was generated from the current versions of them.
+ *
+ * \returns false if the file is outdated or invalid, in which case
+ * the caller should fall back to the XML metadata.
+ */
+bool Ground::LoadBinarySettingsFile(const Path& path, const Path& tileset_path, const Path& settings_path)
+{
+    ifstream file(path.utf8_str(), ios::in | ios::binary | ios::ate);
+    if (!file)
+        return false;
+
+    streamsize size = file.tellg();
+    if (size < static_cast<streamsize>(TILESET_BIN_HEADER_SIZE))
+        return false;
+
+    vector<char> buf(size);
+    file.seekg(0);
+    if (!file.read(buf.data(), size))
+        return false;
+
+    if (memcmp(buf.data(), TILESET_BIN_MAGIC, 4) != 0 || read_le32(&buf[4]) != TILESET_BIN_VERSION) {
+        warn(format("Ignoring binary tileset metadata '%s' of unknown format", path.utf8_str().c_str()));
+        return false;
+    }
+
+    uint64_t png_hash = 0;
+    uint64_t xml_hash = 0;
+    if (!hash_file(tileset_path, png_hash) || !hash_file(settings_path, xml_hash))
+        return false;
+
+    if (read_le64(&buf[8]) != png_hash || read_le64(&buf[16]) != xml_hash) {
+        warn(format("Binary tileset metadata '%s' is outdated, regenerate it with tscproc", path.utf8_str().c_str()));
+        return false;
+    }
+
+    int rows = static_cast<int32_t>(read_le32(&buf[24]));
+    int cols = static_cast<int32_t>(read_le32(&buf[28]));
+    size_t tilecount = read_le32(&buf[32]);
+    size_t count     = read_le32(&buf[36]);
+    if (rows <= 0 || cols <= 0 || buf.size() != TILESET_BIN_HEADER_SIZE + 8 * tilecount + 16 * count) {
+        warn(format("Ignoring corrupt binary tileset metadata '%s'", path.utf8_str().c_str()));
+        return false;
+    }
+
+    vector<ColrectRange> tiles(tilecount);
+    const char* p = &buf[TILESET_BIN_HEADER_SIZE];
+    for (size_t i=0; i < tilecount; i++, p += 8) {
+        tiles[i].first = read_le32(p);
+        tiles[i].count = read_le32(p + 4);
+
+        if (static_cast<size_t>(tiles[i].first) + tiles[i].count > count) {
+            warn(format("Ignoring corrupt binary tileset metadata '%s'", path.utf8_str().c_str()));
+            return false;
+        }
+    }
+
+    m_rows = rows;
+    m_cols = cols;
+    m_tile_colrects.swap(tiles);
+    m_colrects.clear();
+    m_colrects.reserve(count);
+
+    for (size_t i=0; i < count; i++, p += 16) {
+        m_colrects.emplace_back(static_cast<int32_t>(read_le32(p)),
+                                static_cast<int32_t>(read_le32(p + 4)),
+                                static_cast<int32_t>(read_le32(p + 8)),
+                                static_cast<int32_t>(read_le32(p + 12)));
+    }
+
+    return true;
+}
+
+/**
+ * Returns the collision rectangles of the tile with the given ID
+ * in the tileset. The rectangles are in pixel coordinates of the
+ * tileset image.
+ *
+ * \param[out] count
+ * Receives the number of collision rectangles, which is zero if the
+ * tile has no collision.
+ *
+ * \returns a pointer to the first of `count` rectangles.
+ */
+const sf::FloatRect* Ground::GetColrects(int tileid, size_t& count) const
+{
+    if (tileid < 0 || static_cast<size_t>(tileid) >= m_tile_colrects.size()) {
+        count = 0;
+        return nullptr;
+    }
+
+    const ColrectRange& range = m_tile_colrects[tileid];
+    count = range.count;
+    return count > 0 ? &m_colrects[range.first] : nullptr;
+}
+
+/* Returns the shader for drawing dense chunks, compiling it on first
+ * use, or nullptr if the graphics driver does not support shaders. */
+static sf::Shader* get_tilemap_shader()
+{
+    static unique_ptr<sf::Shader> sp_shader;
+    static bool s_unavailable = false;
+
+    if (!sp_shader && !s_unavailable) {
+        if (sf::Shader::isAvailable()) {
+            sp_shader.reset(new sf::Shader());
+            if (!sp_shader->loadFromMemory(TILEMAP_FRAGMENT_SHADER, sf::Shader::Fragment)) {
+                warn("Failed to compile the tilemap shader, drawing grounds without it");
+                sp_shader.reset();
+            }
+        }
+
+        s_unavailable = !sp_shader;
+    }
+
+    return sp_shader.get();
+}
+
+// Returns the smallest rectangle containing both `a' and `b'.
+static sf::FloatRect unite_rects(const sf::FloatRect& a, const sf::FloatRect& b)
+{
+    float left   = min(a.left, b.left);
+    float top    = min(a.top,  b.top);
+    float right  = max(a.left + a.width,  b.left + b.width);
+    float bottom = max(a.top  + a.height, b.top  + b.height);
+    return sf::FloatRect(left, top, right - left, bottom - top);
+}
+
+/**
+ * Distributes the given fields onto the chunks by the position of
+ * their top-left corner and packs them. No vertices are built.
+ *
+ * A chunk covers m_chunk_cols x m_chunk_rows cells of the tile grid.
+ * If at least a third of them is used, i.e. if a dense array of
+ * 16-bit tile IDs needs less memory than a list of GridField, the
+ * chunk is dense. Fields on an already used cell of a dense chunk
+ * are stored as free fields, so that no field gets lost.
+ */
+void Ground::SplitIntoChunks(const Field* p_fields, size_t count)
+{
+    // Fields with tile IDs the tileset does not have cannot be drawn
+    size_t tilecount = m_tile_texcoords.size();
+    auto is_invalid  = [tilecount](const Field& field){ return field.tileid < 0 || static_cast<size_t>(field.tileid) >= tilecount; };
+    size_t invalid   = count_if(p_fields, p_fields + count, is_invalid);
+    if (invalid > 0) {
+        warn(format("Ignoring %d fields with tile IDs not in tileset '%s'", static_cast<int>(invalid), m_tileset.c_str()));
+
+        vector<Field> valid_fields;
+        valid_fields.reserve(count - invalid);
+        remove_copy_if(p_fields, p_fields + count, back_inserter(valid_fields), is_invalid);
+        SplitIntoChunks(valid_fields.data(), valid_fields.size());
+        return;
+    }
+
+    m_chunks.clear();
+    m_chunk_grid.clear();
+    m_built_bytes = 0;
+    m_bounds = sf::FloatRect();
+
+    m_chunk_cols = max(1, CHUNK_SIZE / m_tilewidth);
+    m_chunk_rows = max(1, CHUNK_SIZE / m_tileheight);
+    float chunkwidth  = static_cast<float>(m_chunk_cols * m_tilewidth);
+    float chunkheight = static_cast<float>(m_chunk_rows * m_tileheight);
+
+    if (count == 0)
+        return;
+
+    // Chunk position of each field and the extent of all of them
+    vector<sf::Vector2i> field_chunks(count);
+    sf::Vector2i min_chunk(INT_MAX, INT_MAX);
+    sf::Vector2i max_chunk(INT_MIN, INT_MIN);
+
+    for (size_t i=0; i < count; i++) {
+        sf::Vector2i pos(static_cast<int>(floor(p_fields[i].x / chunkwidth)),
+                         static_cast<int>(floor(p_fields[i].y / chunkheight)));
+        min_chunk.x = min(min_chunk.x, pos.x);
+        min_chunk.y = min(min_chunk.y, pos.y);
+        max_chunk.x = max(max_chunk.x, pos.x);
+        max_chunk.y = max(max_chunk.y, pos.y);
+        field_chunks[i] = pos;
+    }
+
+    m_chunk_grid_origin = min_chunk;
+    m_chunk_grid_width  = max_chunk.x - min_chunk.x + 1;
+    m_chunk_grid.assign(m_chunk_grid_width * (max_chunk.y - min_chunk.y + 1), -1);
+
+    // Create the chunks and count the fields that can go on the grid
+    vector<size_t> grid_counts;
+    vector<size_t> field_indices(count); // Chunk index of each field
+    GridField packed;
+
+    for (size_t i=0; i < count; i++) {
+        const Field& field = p_fields[i];
+        sf::FloatRect rect(field.x, field.y, m_tilewidth, m_tileheight);
+        int& index = m_chunk_grid[(field_chunks[i].y - min_chunk.y) * m_chunk_grid_width + field_chunks[i].x - min_chunk.x];
+
+        if (index < 0) {
+            index = static_cast<int>(m_chunks.size());
+            m_chunks.emplace_back();
+            m_chunks.back().bounds     = rect;
+            m_chunks.back().first_col  = field_chunks[i].x * m_chunk_cols;
+            m_chunks.back().first_row  = field_chunks[i].y * m_chunk_rows;
+            m_chunks.back().tile_count = 0;
+            m_chunks.back().built      = false;
+            grid_counts.push_back(0);
+        }
+
+        Chunk& chunk = m_chunks[index];
+        chunk.bounds = unite_rects(chunk.bounds, rect);
+        field_indices[i] = index;
+
+        if (PackField(field, packed))
+            grid_counts[index]++;
+    }
+
+    size_t cells = m_chunk_cols * m_chunk_rows;
+    for (size_t i=0; i < m_chunks.size(); i++) {
+        if (grid_counts[i] * sizeof(GridField) >= cells * sizeof(uint16_t))
+            m_chunks[i].tiles.assign(cells, EMPTY_CELL);
+        else
+            m_chunks[i].grid_fields.reserve(grid_counts[i]);
+
+        m_bounds = i == 0 ? m_chunks[i].bounds : unite_rects(m_bounds, m_chunks[i].bounds);
+    }
+
+    // Distribute the fields
+    for (size_t i=0; i < count; i++) {
+        Chunk& chunk = m_chunks[field_indices[i]];
+
+        if (!PackField(p_fields[i], packed)) {
+            chunk.free_fields.push_back(p_fields[i]);
+        }
+        else if (chunk.tiles.empty()) {
+            chunk.grid_fields.push_back(packed);
+        }
+        else {
+            uint16_t& cell = chunk.tiles[(packed.row - chunk.first_row) * m_chunk_cols + packed.col - chunk.first_col];
+            if (cell == EMPTY_CELL) {
+                cell = packed.tileid;
+                chunk.tile_count++;
+            }
+            else {
+                chunk.free_fields.push_back(p_fields[i]);
+            }
+        }
+    }
+
+    for (Chunk& chunk: m_chunks) {
+        stable_sort(chunk.grid_fields.begin(), chunk.grid_fields.end(), GridFieldLess);
+    }
+}
+
+// Orders grid fields by row, then by column.
+bool Ground::GridFieldLess(const GridField& a, const GridField& b)
+{
+    return a.row < b.row || (a.row == b.row && a.col < b.col);
+}
+
+/* Converts `field' into a GridField if it is on the tile grid and
+ * its grid position and tile ID fit into 16 bits. Returns false
+ * if that is not possible. */
+bool Ground::PackField(const Field& field, GridField& packed) const
+{
+    int col = static_cast<int>(floor(field.x / m_tilewidth));
+    int row = static_cast<int>(floor(field.y / m_tileheight));
+
+    if (static_cast<float>(col * m_tilewidth) != field.x || static_cast<float>(row * m_tileheight) != field.y)
+        return false;
+    if (col < INT16_MIN || col > INT16_MAX || row < INT16_MIN || row > INT16_MAX)
+        return false;
+    if (field.tileid < 0 || field.tileid >= EMPTY_CELL)
+        return false;
+
+    packed.col    = static_cast<int16_t>(col);
+    packed.row    = static_cast<int16_t>(row);
+    packed.tileid = static_cast<uint16_t>(field.tileid);
+    return true;
+}
+
+/**
+ * Returns the area covered by all fields of this Ground, in the
+ * coordinates of its parent (i.e. with the Ground's transformation
+ * applied). Empty if the Ground has no fields.
+ */
+sf::FloatRect Ground::GetBounds() const
+{
+    return getTransform().transformRect(m_bounds);
+}
+
+/**
+ * Returns the ID of the tile at the given position, given in the
+ * coordinates of this Ground's parent, or NO_TILE if there is none.
+ * If multiple fields overlap at that position, any of them may be
+ * returned.
+ *
+ * For dense chunks (see SplitIntoChunks()), this takes constant time.
+ * Fields off the grid are only found in the chunk their top-left
+ * corner lies in.
+ */
+int Ground::GetTileAt(const sf::Vector2f& position) const
+{
+    if (m_chunk_grid.empty())
+        return NO_TILE;
+
+    sf::Vector2f local = getInverseTransform().transformPoint(position);
+    int col = static_cast<int>(floor(local.x / m_tilewidth));
+    int row = static_cast<int>(floor(local.y / m_tileheight));
+
+    int index = FindChunk(col, row);
+    if (index < 0)
+        return NO_TILE;
+
+    const Chunk& chunk = m_chunks[index];
+    if (!chunk.tiles.empty()) {
+        uint16_t cell = chunk.tiles[(row - chunk.first_row) * m_chunk_cols + col - chunk.first_col];
+        if (cell != EMPTY_CELL)
+            return cell;
+    }
+    else if (col >= INT16_MIN && col <= INT16_MAX && row >= INT16_MIN && row <= INT16_MAX) {
+        GridField key;
+        key.col = static_cast<int16_t>(col);
+        key.row = static_cast<int16_t>(row);
+        auto iter = lower_bound(chunk.grid_fields.begin(), chunk.grid_fields.end(), key, GridFieldLess);
+
+        if (iter != chunk.grid_fields.end() && iter->row == key.row && iter->col == key.col)
+            return iter->tileid;
+    }
+
+    for (const Field& field: chunk.free_fields) {
+        if (field.tileid != NO_TILE && sf::FloatRect(field.x, field.y, m_tilewidth, m_tileheight).contains(local))
+            return field.tileid;
+    }
+
+    return NO_TILE;
+}
+
+/* Returns the index of the chunk containing the given grid cell,
+ * or -1 if there is none. */
+int Ground::FindChunk(int col, int row) const
+{
+    if (m_chunk_grid.empty())
+        return -1;
+
+    // Chunk position relative to the chunk grid (rounding towards negative infinity)
+    int chunkx = (col >= 0 ? col / m_chunk_cols : (col + 1) / m_chunk_cols - 1) - m_chunk_grid_origin.x;
+    int chunky = (row >= 0 ? row / m_chunk_rows : (row + 1) / m_chunk_rows - 1) - m_chunk_grid_origin.y;
+    if (chunkx < 0 || chunky < 0 || chunkx >= m_chunk_grid_width || chunky * m_chunk_grid_width >= static_cast<int>(m_chunk_grid.size()))
+        return -1;
+
+    return m_chunk_grid[chunky * m_chunk_grid_width + chunkx];
+}
+
 /**
- * Merges the fields specified when calling the constructor with the information
- * from the tilset, thereby constructing this Ground's vertex array.
+ * Sets the tile of the grid cell in the given column and row, counted
+ * from this Ground's origin in tiles. Pass NO_TILE to remove the tile.
+ * Takes constant time, except for the first edit in a sparse chunk,
+ * which turns it into a dense one.
  */
-void Ground::ReadVertices(const vector<Field>& fields, const sf::Image& img)
+void Ground::SetTile(int col, int row, int tileid)
 {
+    if (tileid != NO_TILE)
+        CheckTileID(tileid);
+
+    int index = FindChunk(col, row);
+    if (index < 0) {
+        if (tileid == NO_TILE)
+            return;
+
+        index = static_cast<int>(CreateChunk(col, row, sf::FloatRect(col * m_tilewidth, row * m_tileheight, m_tilewidth, m_tileheight)));
+    }
+
+    if (m_chunks[index].tiles.empty())
+        MakeDense(index);
+
+    Chunk& chunk   = m_chunks[index];
+    size_t cell    = (row - chunk.first_row) * m_chunk_cols + col - chunk.first_col;
+    uint16_t value = tileid == NO_TILE ? EMPTY_CELL : static_cast<uint16_t>(tileid);
+
+    if (chunk.tiles[cell] == value)
+        return;
+    else if (chunk.tiles[cell] == EMPTY_CELL)
+        chunk.tile_count++;
+    else if (value == EMPTY_CELL)
+        chunk.tile_count--;
+
+    chunk.tiles[cell] = value;
+
+    // Bounds only grow, so that removing a field takes constant time
+    if (value != EMPTY_CELL) {
+        sf::FloatRect rect(col * m_tilewidth, row * m_tileheight, m_tilewidth, m_tileheight);
+        chunk.bounds = unite_rects(chunk.bounds, rect);
+        m_bounds     = unite_rects(m_bounds, rect);
+    }
+
+    if (!chunk.built)
+        return;
+
+    if (chunk.p_tilemap) {
+        // A DrawList still drawing the old tile map must not see the change
+        if (chunk.p_tilemap.use_count() > 1) {
+            if (!CreateTilemap(chunk))
+                throw(runtime_error("Failed to recreate the tile map of a ground chunk"));
+            return;
+        }
+
+        sf::Uint8 texel[4] = {static_cast<sf::Uint8>(value & 0xFF), static_cast<sf::Uint8>(value >> 8), 0, static_cast<sf::Uint8>(value == EMPTY_CELL ? 0 : 255)};
+        chunk.p_tilemap->update(texel, 1, 1, static_cast<unsigned int>(cell % m_chunk_cols), static_cast<unsigned int>(cell / m_chunk_cols));
+    }
+    else if (value == EMPTY_CELL) {
+        FreeQuad(chunk, chunk.cell_quads[cell]);
+        chunk.cell_quads[cell] = -1;
+    }
+    else {
+        if (chunk.cell_quads[cell] < 0)
+            chunk.cell_quads[cell] = AllocateQuad(chunk);
+
+        WriteQuad(chunk, chunk.cell_quads[cell], col * m_tilewidth, row * m_tileheight, tileid);
+    }
+}
+
+/**
+ * Adds a field at an arbitrary position, which may overlap others.
+ * Use SetTile() for fields on the grid instead, which is cheaper in
+ * memory and drawing.
+ *
+ * \returns a handle to pass to RemoveField() and SetFieldTile().
+ */
+FieldHandle Ground::AddField(const Field& field)
+{
+    CheckTileID(field.tileid);
+
+    sf::FloatRect rect(field.x, field.y, m_tilewidth, m_tileheight);
+    int col   = static_cast<int>(floor(field.x / m_tilewidth));
+    int row   = static_cast<int>(floor(field.y / m_tileheight));
+    int index = FindChunk(col, row);
+    if (index < 0)
+        index = static_cast<int>(CreateChunk(col, row, rect));
+
+    Chunk& chunk = m_chunks[index];
+    chunk.bounds = unite_rects(chunk.bounds, rect);
+    m_bounds     = unite_rects(m_bounds, rect);
+
+    size_t slot = chunk.free_fields.size();
+    if (chunk.unused_free_fields.empty()) {
+        chunk.free_fields.push_back(field);
+    }
+    else {
+        slot = chunk.unused_free_fields.back();
+        chunk.unused_free_fields.pop_back();
+        chunk.free_fields[slot] = field;
+    }
+
+    if (chunk.built) {
+        if (chunk.free_field_quads.size() <= slot)
+            chunk.free_field_quads.resize(slot + 1, -1);
+
+        chunk.free_field_quads[slot] = AllocateQuad(chunk);
+        WriteQuad(chunk, chunk.free_field_quads[slot], field.x, field.y, field.tileid);
+    }
+
+    FieldHandle handle;
+    handle.chunk = static_cast<size_t>(index);
+    handle.slot  = slot;
+    return handle;
+}
+
+/// Removes a field added with AddField().
+void Ground::RemoveField(const FieldHandle& handle)
+{
+    if (handle.chunk >= m_chunks.size() || handle.slot >= m_chunks[handle.chunk].free_fields.size() || m_chunks[handle.chunk].free_fields[handle.slot].tileid == NO_TILE)
+        throw(runtime_error("Invalid field handle"));
+
+    Chunk& chunk = m_chunks[handle.chunk];
+    chunk.free_fields[handle.slot].tileid = NO_TILE;
+    chunk.unused_free_fields.push_back(handle.slot);
+
+    if (chunk.built) {
+        FreeQuad(chunk, chunk.free_field_quads[handle.slot]);
+        chunk.free_field_quads[handle.slot] = -1;
+    }
+}
+
+/// Changes the tile of a field added with AddField().
+void Ground::SetFieldTile(const FieldHandle& handle, int tileid)
+{
+    if (handle.chunk >= m_chunks.size() || handle.slot >= m_chunks[handle.chunk].free_fields.size() || m_chunks[handle.chunk].free_fields[handle.slot].tileid == NO_TILE)
+        throw(runtime_error("Invalid field handle"));
+
+    CheckTileID(tileid);
+
+    Chunk& chunk = m_chunks[handle.chunk];
+    Field& field = chunk.free_fields[handle.slot];
+    field.tileid = tileid;
+
+    if (chunk.built)
+        WriteQuad(chunk, chunk.free_field_quads[handle.slot], field.x, field.y, tileid);
+}
+
+// Throws if the tileset has no tile with the given ID.
+void Ground::CheckTileID(int tileid) const
+{
+    if (!mp_tileset)
+        throw(runtime_error("Ground edited before a tileset was set"));
+    if (tileid < 0 || static_cast<size_t>(tileid) >= m_tile_texcoords.size())
+        throw(runtime_error(format("Tile ID %d is not in tileset '%s'", tileid, m_tileset.c_str())));
+}
+
+/* Creates an empty dense chunk for the grid cell in the given column
+ * and row, which must not have one yet, and enlarges the chunk grid
+ * as needed. `bounds' is the area of the first field to be added.
+ * Returns the index of the new chunk. */
+size_t Ground::CreateChunk(int col, int row, const sf::FloatRect& bounds)
+{
+    sf::Vector2i pos(col >= 0 ? col / m_chunk_cols : (col + 1) / m_chunk_cols - 1,
+                     row >= 0 ? row / m_chunk_rows : (row + 1) / m_chunk_rows - 1);
+
+    if (m_chunk_grid.empty()) {
+        m_chunk_grid_origin = pos;
+        m_chunk_grid_width  = 1;
+        m_chunk_grid.assign(1, -1);
+        m_bounds = bounds;
+    }
+    else {
+        int height = static_cast<int>(m_chunk_grid.size()) / m_chunk_grid_width;
+        sf::Vector2i origin(min(m_chunk_grid_origin.x, pos.x), min(m_chunk_grid_origin.y, pos.y));
+        sf::Vector2i end(max(m_chunk_grid_origin.x + m_chunk_grid_width, pos.x + 1), max(m_chunk_grid_origin.y + height, pos.y + 1));
+
+        if (origin != m_chunk_grid_origin || end.x - origin.x != m_chunk_grid_width || end.y - origin.y != height) {
+            vector<int> grid((end.x - origin.x) * (end.y - origin.y), -1);
+            for (int y=0; y < height; y++)
+                for (int x=0; x < m_chunk_grid_width; x++)
+                    grid[(y + m_chunk_grid_origin.y - origin.y) * (end.x - origin.x) + x + m_chunk_grid_origin.x - origin.x] = m_chunk_grid[y * m_chunk_grid_width + x];
+
+            m_chunk_grid.swap(grid);
+            m_chunk_grid_origin = origin;
+            m_chunk_grid_width  = end.x - origin.x;
+        }
+    }
+
+    m_chunk_grid[(pos.y - m_chunk_grid_origin.y) * m_chunk_grid_width + pos.x - m_chunk_grid_origin.x] = static_cast<int>(m_chunks.size());
+
+    m_chunks.emplace_back();
+    Chunk& chunk     = m_chunks.back();
+    chunk.bounds     = bounds;
+    chunk.first_col  = pos.x * m_chunk_cols;
+    chunk.first_row  = pos.y * m_chunk_rows;
+    chunk.tile_count = 0;
+    chunk.built      = false;
+    chunk.tiles.assign(m_chunk_cols * m_chunk_rows, EMPTY_CELL);
+
+    return m_chunks.size() - 1;
+}
+
+/* Moves the fields of a sparse chunk into a dense tile array, so that
+ * its cells can be edited in constant time. A built chunk is built
+ * again, as its vertex layout changes. */
+void Ground::MakeDense(size_t index)
+{
+    Chunk& chunk = m_chunks[index];
+    bool built   = chunk.built;
+
+    if (built)
+        ReleaseChunk(index);
+
+    chunk.tiles.assign(m_chunk_cols * m_chunk_rows, EMPTY_CELL);
+    for (const GridField& field: chunk.grid_fields) {
+        uint16_t& cell = chunk.tiles[(field.row - chunk.first_row) * m_chunk_cols + field.col - chunk.first_col];
+        if (cell == EMPTY_CELL) {
+            cell = field.tileid;
+            chunk.tile_count++;
+        }
+        else {
+            chunk.free_fields.push_back(Field(field.col * m_tilewidth, field.row * m_tileheight, field.tileid));
+        }
+    }
+
+    vector<GridField>().swap(chunk.grid_fields);
+
+    if (built)
+        BuildChunk(index);
+}
+
+/* Returns the index of an unused quad in the chunk's vertices,
+ * appending one if there is none. */
+int32_t Ground::AllocateQuad(Chunk& chunk)
+{
+    if (!chunk.unused_quads.empty()) {
+        int32_t quad = chunk.unused_quads.back();
+        chunk.unused_quads.pop_back();
+        return quad;
+    }
+
+    size_t count = chunk.vertices.getVertexCount();
+    chunk.vertices.resize(count + 4);
+    m_built_bytes += 4 * sizeof(sf::Vertex);
+
+    return static_cast<int32_t>(count / 4);
+}
+
+// Collapses the quad so that it draws nothing and marks it unused.
+void Ground::FreeQuad(Chunk& chunk, int32_t quad) const
+{
+    for (size_t i=0; i < 4; i++)
+        chunk.vertices[quad*4 + i].position = sf::Vector2f(0.0f, 0.0f);
+
+    chunk.unused_quads.push_back(quad);
+    MarkDirty(chunk, quad*4, 4);
+}
+
+// Sets the four vertices of the given quad for a single field.
+void Ground::WriteQuad(Chunk& chunk, int32_t quad, float x, float y, int tileid) const
+{
+    sf::Vertex* p_quad = &chunk.vertices[quad*4];
+    sf::Vector2f tex   = m_tile_texcoords[tileid];
+    float tilewidth    = m_tilewidth;
+    float tileheight   = m_tileheight;
+
+    p_quad[0].position  = sf::Vector2f(x,             y);
+    p_quad[1].position  = sf::Vector2f(x + tilewidth, y);
+    p_quad[2].position  = sf::Vector2f(x + tilewidth, y + tileheight);
+    p_quad[3].position  = sf::Vector2f(x,             y + tileheight);
+    p_quad[0].texCoords = sf::Vector2f(tex.x,             tex.y);
+    p_quad[1].texCoords = sf::Vector2f(tex.x + tilewidth, tex.y);
+    p_quad[2].texCoords = sf::Vector2f(tex.x + tilewidth, tex.y + tileheight);
+    p_quad[3].texCoords = sf::Vector2f(tex.x,             tex.y + tileheight);
+
+    MarkDirty(chunk, quad*4, 4);
+}
+
+/* Records that the given range of the chunk's vertices changed and
+ * needs to be uploaded to its vertex buffer on the next drawing. */
+void Ground::MarkDirty(const Chunk& chunk, size_t first, size_t count) const
+{
+#ifdef TSC_HAVE_VERTEX_BUFFER
+    if (chunk.dirty_end == chunk.dirty_first) {
+        chunk.dirty_first = first;
+        chunk.dirty_end   = first + count;
+    }
+    else {
+        chunk.dirty_first = min(chunk.dirty_first, first);
+        chunk.dirty_end   = max(chunk.dirty_end, first + count);
+    }
+#else
+    (void) chunk;
+    (void) first;
+    (void) count;
+#endif
+}
+
+/**
+ * Returns the area covered by the fields of the chunk with the given
+ * index, in the coordinates of this Ground's parent (i.e. with the
+ * Ground's transformation applied).
+ */
+sf::FloatRect Ground::GetChunkBounds(size_t index) const
+{
+    return getTransform().transformRect(m_chunks[index].bounds);
+}
+
+/**
+ * Merges the fields of the given chunk with the information from the
+ * tileset, thereby constructing the chunk's vertex array. Does nothing
+ * if the chunk is already built.
+ *
+ * \returns the number of bytes the chunk's vertices occupy.
+ */
+size_t Ground::BuildChunk(size_t index)
+{
+    Chunk& chunk = m_chunks[index];
+
+    if (!chunk.built) {
+        bool use_tilemap = !chunk.tiles.empty() && Settings::enable_shader_tilemap && CreateTilemap(chunk);
+        FillVertices(chunk, use_tilemap);
+        chunk.built = true;
+        m_built_bytes += GetChunkBytes(chunk);
+    }
+
+    return GetChunkBytes(chunk);
+}
+
+/**
+ * Builds all of the given chunks like BuildChunk(), but generates
+ * their vertices on all CPU cores at once. Tile map textures are
+ * still created on the calling thread.
+ *
+ * \returns the number of bytes of the chunks that were built.
+ */
+size_t Ground::BuildChunks(const vector<size_t>& indices)
+{
+    vector<Chunk*> pending;
+    vector<char> use_tilemap;
+    for (size_t index: indices) {
+        Chunk& chunk = m_chunks[index];
+        if (chunk.built)
+            continue;
+
+        pending.push_back(&chunk);
+        use_tilemap.push_back(!chunk.tiles.empty() && Settings::enable_shader_tilemap && CreateTilemap(chunk));
+        chunk.built = true; // Also guards against duplicate indices
+    }
+
+    Jobs::ParallelFor("Ground::FillVertices", pending.size(), [&](size_t i) {
+            FillVertices(*pending[i], use_tilemap[i] != 0);
+        });
+
+    size_t bytes = 0;
+    for (const Chunk* p_chunk: pending)
+        bytes += GetChunkBytes(*p_chunk);
+
+    m_built_bytes += bytes;
+    return bytes;
+}
+
+/* Merges the fields of the chunk with the information from the
+ * tileset, thereby constructing the chunk's vertex array. The cells
+ * of dense chunks are skipped if `use_tilemap' is set. Only touches
+ * `chunk', so it may run for different chunks concurrently.
+ *
+ * This runs in two passes. The first one gathers the top-left
+ * position and texture coordinate of each field into separate
+ * arrays, the second one writes the four vertices of each field from
+ * these arrays. Both loops are free of divisions and branches, so the
+ * compiler can vectorise them. */
+void Ground::FillVertices(Chunk& chunk, bool use_tilemap) const
+{
+    size_t quads = chunk.grid_fields.size() + chunk.free_fields.size() - chunk.unused_free_fields.size() + (use_tilemap ? 0 : chunk.tile_count);
+
+    // Remember where the quads go, for editing
+    chunk.cell_quads.assign(use_tilemap ? 0 : chunk.tiles.size(), -1);
+    chunk.free_field_quads.assign(chunk.free_fields.size(), -1);
+    chunk.unused_quads.clear();
+
+    // One array per component: x, y, u, v
+    vector<float> corners(quads * 4);
+    float* p_x = corners.data();
+    float* p_y = p_x + quads;
+    float* p_u = p_y + quads;
+    float* p_v = p_u + quads;
+    size_t n = 0;
+
+    if (!use_tilemap) {
+        for (size_t cell=0; cell < chunk.tiles.size(); cell++) {
+            if (chunk.tiles[cell] == EMPTY_CELL)
+                continue;
+
+            p_x[n] = static_cast<float>((chunk.first_col + static_cast<int>(cell) % m_chunk_cols) * m_tilewidth);
+            p_y[n] = static_cast<float>((chunk.first_row + static_cast<int>(cell) / m_chunk_cols) * m_tileheight);
+            p_u[n] = m_tile_texcoords[chunk.tiles[cell]].x;
+            p_v[n] = m_tile_texcoords[chunk.tiles[cell]].y;
+            chunk.cell_quads[cell] = static_cast<int32_t>(n);
+            n++;
+        }
+    }
+    for (const GridField& field: chunk.grid_fields) {
+        p_x[n] = static_cast<float>(field.col * m_tilewidth);
+        p_y[n] = static_cast<float>(field.row * m_tileheight);
+        p_u[n] = m_tile_texcoords[field.tileid].x;
+        p_v[n] = m_tile_texcoords[field.tileid].y;
+        n++;
+    }
+    for (size_t i=0; i < chunk.free_fields.size(); i++) {
+        const Field& field = chunk.free_fields[i];
+        if (field.tileid == NO_TILE)
+            continue; // Removed
+
+        p_x[n] = field.x;
+        p_y[n] = field.y;
+        p_u[n] = m_tile_texcoords[field.tileid].x;
+        p_v[n] = m_tile_texcoords[field.tileid].y;
+        chunk.free_field_quads[i] = static_cast<int32_t>(n);
+        n++;
+    }
+
     // Allocate enough vertices for all the fields
     // (4 vertices for one field required to describe a quad)
-    m_vertices.setPrimitiveType(sf::Quads);
-    m_vertices.resize(fields.size() * 4);
+    chunk.vertices.setPrimitiveType(sf::Quads);
+    chunk.vertices.resize(quads * 4);
+    if (quads == 0)
+        return;
 
-    // Calculate the size of one tile (and thereby, one field).
-    // The tileset dimensions are required to be an exact multiple.
-    int tilewidth  = img.getSize().x / m_cols;
-    int tileheight = img.getSize().y / m_rows;
+    // Define the quad for each field (under the assumption that the entire
+    // Ground is at (0|0) -- transformations will take care of moving it around)
+    // and map it to the part of the texture showing the field's tile.
+    float tilewidth  = m_tilewidth;
+    float tileheight = m_tileheight;
+    sf::Vertex* p_vertices = &chunk.vertices[0];
+
+    for (size_t i=0; i < quads; i++) {
+        sf::Vertex* p_quad = p_vertices + i*4;
+        p_quad[0].position  = sf::Vector2f(p_x[i],             p_y[i]);
+        p_quad[1].position  = sf::Vector2f(p_x[i] + tilewidth, p_y[i]);
+        p_quad[2].position  = sf::Vector2f(p_x[i] + tilewidth, p_y[i] + tileheight);
+        p_quad[3].position  = sf::Vector2f(p_x[i],             p_y[i] + tileheight);
+        p_quad[0].texCoords = sf::Vector2f(p_u[i],             p_v[i]);
+        p_quad[1].texCoords = sf::Vector2f(p_u[i] + tilewidth, p_v[i]);
+        p_quad[2].texCoords = sf::Vector2f(p_u[i] + tilewidth, p_v[i] + tileheight);
+        p_quad[3].texCoords = sf::Vector2f(p_u[i],             p_v[i] + tileheight);
+    }
+}
 
-    for(size_t i=0; i < fields.size(); i++) {
-        // Define the quad for this field (under the assumption that the entire
-        // Ground is at (0|0) -- transformations will take care of moving it around).
-        m_vertices[i*4  ].position = sf::Vector2f(fields[i].x,             fields[i].y);
-        m_vertices[i*4+1].position = sf::Vector2f(fields[i].x + tilewidth, fields[i].y);
-        m_vertices[i*4+2].position = sf::Vector2f(fields[i].x + tilewidth, fields[i].y + tileheight);
-        m_vertices[i*4+3].position = sf::Vector2f(fields[i].x,             fields[i].y + tileheight);
+/* Uploads the tile IDs of a dense chunk into a texture for the
+ * tilemap shader. Returns false if shaders are unavailable or the
+ * texture cannot be created. */
+bool Ground::CreateTilemap(Chunk& chunk) const
+{
+    if (!get_tilemap_shader())
+        return false;
 
-        // Map it to a part of the texture of equal dimensions as described by
-        // the tile index for this field.
-        int row = fields[i].tileid / m_cols;
-        int col = fields[i].tileid % m_cols;
-        m_vertices[i*4  ].texCoords = sf::Vector2f(col * tilewidth,             row * tileheight);
-        m_vertices[i*4+1].texCoords = sf::Vector2f(col * tilewidth + tilewidth, row * tileheight);
-        m_vertices[i*4+2].texCoords = sf::Vector2f(col * tilewidth + tilewidth, row * tileheight + tileheight);
-        m_vertices[i*4+3].texCoords = sf::Vector2f(col * tilewidth,             row * tilewidth + tileheight);
+    vector<sf::Uint8> pixels(chunk.tiles.size() * 4, 0);
+    for (size_t cell=0; cell < chunk.tiles.size(); cell++) {
+        if (chunk.tiles[cell] == EMPTY_CELL)
+            continue;
+
+        pixels[cell*4  ] = static_cast<sf::Uint8>(chunk.tiles[cell] & 0xFF);
+        pixels[cell*4+1] = static_cast<sf::Uint8>(chunk.tiles[cell] >> 8);
+        pixels[cell*4+3] = 255;
+    }
+
+    chunk.p_tilemap.reset(new sf::Texture());
+    if (!chunk.p_tilemap->create(m_chunk_cols, m_chunk_rows)) {
+        chunk.p_tilemap.reset();
+        return false;
     }
+
+    chunk.p_tilemap->update(pixels.data());
+    return true;
 }
 
-void Ground::draw(sf::RenderTarget& target, sf::RenderStates states) const
+// Memory used by a built chunk's vertices and tile map texture.
+size_t Ground::GetChunkBytes(const Chunk& chunk) const
 {
+    size_t bytes = chunk.vertices.getVertexCount() * sizeof(sf::Vertex);
+    if (chunk.p_tilemap)
+        bytes += chunk.tiles.size() * 4;
+
+    return bytes;
+}
+
+/**
+ * Frees the vertices of the given chunk. The chunk's fields are
+ * kept, so it can be built again later.
+ *
+ * \returns the number of bytes freed.
+ */
+size_t Ground::ReleaseChunk(size_t index)
+{
+    Chunk& chunk = m_chunks[index];
+    if (!chunk.built)
+        return 0;
+
+    size_t bytes = GetChunkBytes(chunk);
+
+    // clear() would keep the memory allocated, moving frees it.
+    chunk.vertices = sf::VertexArray();
+    chunk.p_tilemap.reset();
+    chunk.cell_quads       = vector<int32_t>();
+    chunk.free_field_quads = vector<int32_t>();
+    chunk.unused_quads     = vector<int32_t>();
+    chunk.built = false;
+#ifdef TSC_HAVE_VERTEX_BUFFER
+    chunk.p_buffer.reset();
+    chunk.dirty_first = chunk.dirty_end = 0;
+#endif
+
+    m_built_bytes -= bytes;
+    return bytes;
+}
+
+/**
+ * Adds the built chunks intersecting the list's current view to
+ * `list`. The chunks' vertex buffers are uploaded here if they
+ * changed, so call this from the main thread.
+ *
+ * The tile maps are recorded at the list's current depth, and the
+ * other fields half a step above, as they may lie on top of the
+ * tile maps' cells. Give the next Ground at least one depth more.
+ */
+void Ground::Record(DrawList& list, sf::RenderStates states) const
+{
+    float depth = list.GetDepth();
+
     states.transform *= getTransform();
-    states.texture = &m_tileset;
+    states.texture = mp_tileset;
+
+    // The view's area in Ground-local coordinates
+    const sf::View& view = list.GetView();
+    sf::FloatRect viewrect(view.getCenter() - view.getSize() / 2.0f, view.getSize());
+    viewrect = states.transform.getInverse().transformRect(viewrect);
+
+    for (const Chunk& chunk: m_chunks) {
+        if (!chunk.built || !chunk.bounds.intersects(viewrect))
+            continue;
+
+        if (chunk.p_tilemap) {
+            list.SetDepth(depth);
+            RecordTilemap(list, states, chunk);
+        }
+
+        if (chunk.vertices.getVertexCount() > 0) {
+            list.SetDepth(depth + 0.5f);
+            RecordVertices(list, states, chunk);
+        }
+    }
+
+    list.SetDepth(depth);
+}
+
+void Ground::draw(sf::RenderTarget& target, sf::RenderStates states) const
+{
+    DrawList list(target.getView());
+    Record(list, states);
+    list.Sort();
+    list.Execute(target);
+}
+
+/* Adds the chunk's vertices from its vertex buffer if possible,
+ * uploading them first if they changed. The buffer is created with
+ * some room to spare, so that adding fields does not require a new
+ * buffer right away. A buffer still held by a DrawList is replaced
+ * rather than updated. */
+void Ground::RecordVertices(DrawList& list, const sf::RenderStates& states, const Chunk& chunk) const
+{
+    size_t count = chunk.vertices.getVertexCount();
+
+#ifdef TSC_HAVE_VERTEX_BUFFER
+    if (sf::VertexBuffer::isAvailable()) {
+        bool in_use = chunk.p_buffer && chunk.dirty_end > chunk.dirty_first && chunk.p_buffer.use_count() > 1;
+        if (!chunk.p_buffer || chunk.p_buffer->getVertexCount() < count || in_use) {
+            chunk.p_buffer = make_shared<sf::VertexBuffer>(sf::Quads, sf::VertexBuffer::Dynamic);
+            if (!chunk.p_buffer->create(count + count / 4)) {
+                chunk.p_buffer.reset();
+                list.AddVertices(&chunk.vertices[0], count, sf::Quads, states);
+                return;
+            }
+
+            chunk.dirty_first = 0;
+            chunk.dirty_end   = count;
+        }
+
+        if (chunk.dirty_end > chunk.dirty_first) {
+            chunk.p_buffer->update(&chunk.vertices[chunk.dirty_first], chunk.dirty_end - chunk.dirty_first, static_cast<unsigned int>(chunk.dirty_first));
+            chunk.dirty_first = chunk.dirty_end = 0;
+        }
+
+        list.AddVertexBuffer(chunk.p_buffer, count, states);
+        return;
+    }
+#endif
+
+    list.AddVertices(&chunk.vertices[0], count, sf::Quads, states);
+}
+
+// Adds a chunk with a tile map as a single quad using the tilemap shader.
+void Ground::RecordTilemap(DrawList& list, sf::RenderStates states, const Chunk& chunk) const
+{
+    float left   = static_cast<float>(chunk.first_col * m_tilewidth);
+    float top    = static_cast<float>(chunk.first_row * m_tileheight);
+    float right  = left + m_chunk_cols * m_tilewidth;
+    float bottom = top  + m_chunk_rows * m_tileheight;
+
+    // Without a texture in the render states, SFML passes the texture coordinates on unchanged
+    sf::Vertex quad[4] = {
+        sf::Vertex(sf::Vector2f(left,  top),    sf::Vector2f(0.0f, 0.0f)),
+        sf::Vertex(sf::Vector2f(right, top),    sf::Vector2f(1.0f, 0.0f)),
+        sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(1.0f, 1.0f)),
+        sf::Vertex(sf::Vector2f(left,  bottom), sf::Vector2f(0.0f, 1.0f))
+    };
+
+    shared_ptr<const sf::Texture> p_tilemap = chunk.p_tilemap;
+    const sf::Texture* p_tileset = mp_tileset;
+    sf::Glsl::Vec2 mapsize(m_chunk_cols, m_chunk_rows);
+    sf::Glsl::Vec2 tilesetsize(m_cols, m_rows);
+
+    sf::Shader* p_shader = get_tilemap_shader(); // Cannot fail, the chunk would have no tile map otherwise
+    states.texture = nullptr;
+    states.shader  = p_shader;
 
-    target.draw(m_vertices, states);
+    // The shader is shared by all chunks, so the uniforms are set right before drawing
+    list.AddCallback([=](sf::RenderTarget& target) {
+        p_shader->setUniform("tilemap", *p_tilemap);
+        p_shader->setUniform("tileset", *p_tileset);
+        p_shader->setUniform("mapsize", mapsize);
+        p_shader->setUniform("tilesetsize", tilesetsize);
+        target.draw(quad, 4, sf::Quads, states);
+    }, states);
 }
@@ -20,10 +20,18 @@
 
 #ifndef TSC_GROUND_HPP
 #define TSC_GROUND_HPP
+#include "draw_list.hpp"
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <SFML/Graphics.hpp>
 
+// forward-declare
+namespace Pathie {
+    class Path;
+}
+
 namespace TSC {
 
     /**
@@ -45,12 +53,34 @@ namespace TSC {
         int tileid;
     };
 
+    /**
+     * The collision rectangles of one tile of a tileset, given as a
+     * range into the Ground's flat list of collision rectangles.
+     */
+    struct ColrectRange
+    {
+        unsigned int first;
+        unsigned int count;
+    };
+
+    /**
+     * Identifies a field added with Ground::AddField(). It stays valid
+     * until the field is removed or the Ground's fields are replaced.
+     */
+    struct FieldHandle
+    {
+        size_t chunk;
+        size_t slot;
+    };
+
     /**
      * The Ground is an SFML-like entity to draw the level ground from a
-     * tileset. It uses just a single, large vertex array for the entire
-     * level ground, thus rendering a Ground object is pretty fast despite
-     * of its usually large extends. The downside of it is that you're
-     * restricted to construct your Ground object from a single tileset.
+     * tileset. The fields are grouped into *chunks* of about CHUNK_SIZE
+     * pixels, each of which has a single vertex array, thus rendering a
+     * Ground object is pretty fast despite of its usually large extends.
+     * Only chunks intersecting the view are drawn. The downside of it is
+     * that you're restricted to construct your Ground object from a single
+     * tileset.
      * This is actually good for level consistency, but if you really need
      * a second tileset, you can still instanciate a second Ground object.
      *
@@ -69,26 +99,169 @@ namespace TSC {
      * is proper task division and allows to construct a Ground object from
      * memory directly if required (could be useful for scripting).
      *
+     * Internally, the ground is a grid of tiles, and chunks are aligned
+     * to it. A chunk filled well enough with fields on the grid stores a
+     * dense 2D array of tile IDs, otherwise it keeps a sparse list of
+     * grid positions with 16-bit coordinates and tile ID. Fields off the
+     * grid are kept as they are. This makes GetTileAt(), which finds the
+     * tile at a position for collision checks, a constant time operation
+     * for dense chunks. Loaders producing large field lists should hand
+     * them over with std::move(), which frees the list's memory as soon
+     * as it has been packed.
+     *
      * Collision information for the ground is read from the tileset metadata
-     * XML as well.
+     * XML as well. Each tile may have any number of collision rectangles,
+     * which are kept in one flat list; a per-tile range table gives the
+     * part of the list that belongs to a specific tile (see GetColrects()).
+     * If tscproc has compiled the XML into the binary metadata format (a
+     * `.tsb` file next to the tileset), that one is read instead, which
+     * avoids the XML parsing.
+     *
+     * If shaders are available and Settings::enable_shader_tilemap is
+     * set, dense chunks are not drawn as one quad per field. Instead,
+     * their tile IDs are uploaded as a small texture, and the chunk is
+     * drawn as a single quad with a fragment shader that looks up the
+     * tile for each pixel in the tileset.
+     *
+     * For the level editor, single fields can be changed without setting
+     * up the whole Ground again. SetTile() changes or removes the tile in
+     * a cell of the grid, while AddField(), RemoveField() and SetFieldTile()
+     * deal with fields at arbitrary positions. Each of them takes constant
+     * time (except for the first edit of a sparse chunk, which makes it
+     * dense) and only rewrites the affected vertices; removed fields leave
+     * unused quads behind, which are reused by later additions. With SFML
+     * 2.5 or newer, the vertices of each chunk live in a vertex buffer on
+     * the graphics card, and only the changed range is uploaded again.
+     *
+     * Record() adds the visible chunks to a DrawList. The vertex
+     * buffers and tile map textures of the chunks are shared with the
+     * list, and if one of them is changed while a list still holds it,
+     * a new one is created instead, so that a list being drawn on the
+     * render thread is not affected by editing the Ground.
+     *
+     * The vertices of a chunk are not built automatically. Whoever owns
+     * the Ground decides which chunks to build (BuildChunk()) and which
+     * to release again (ReleaseChunk()), usually depending on the
+     * distance to the camera; see Level::Update(). Chunks that are not
+     * built are simply not drawn.
      */
     class Ground: public sf::Drawable, public sf::Transformable
     {
     public:
+        /// Edge length of a chunk in pixels, rounded down to whole tiles.
+        static const int CHUNK_SIZE = 1024;
+        /// Returned by GetTileAt() if there is no tile.
+        static const int NO_TILE = -1;
+
         Ground();
         Ground(const std::string& tileset, const std::vector<Field>& fields);
+        Ground(const std::string& tileset, std::vector<Field>&& fields);
 
         void reset(const std::string& tileset, const std::vector<Field>& fields);
+        void reset(const std::string& tileset, std::vector<Field>&& fields);
+        void SetFields(const std::vector<Field>& fields);
+        void SetFields(std::vector<Field>&& fields);
+        void SetFields(const Field* p_fields, size_t count);
+        void LoadTilesetMetadata(const std::string& tileset);
+        void LoadTilesetTexture();
+        void ReloadTileset();
+        inline const std::string& GetTileset() const { return m_tileset; }
+
+        const sf::FloatRect* GetColrects(int tileid, size_t& count) const;
+        sf::FloatRect GetBounds() const;
+        int GetTileAt(const sf::Vector2f& position) const;
+
+        void SetTile(int col, int row, int tileid);
+        FieldHandle AddField(const Field& field);
+        void RemoveField(const FieldHandle& handle);
+        void SetFieldTile(const FieldHandle& handle, int tileid);
+
+        inline size_t GetChunkCount() const { return m_chunks.size(); }
+        sf::FloatRect GetChunkBounds(size_t index) const;
+        inline bool IsChunkBuilt(size_t index) const { return m_chunks[index].built; }
+        size_t BuildChunk(size_t index);
+        size_t BuildChunks(const std::vector<size_t>& indices);
+        size_t ReleaseChunk(size_t index);
+        void Record(DrawList& list, sf::RenderStates states = sf::RenderStates::Default) const;
+        /// Memory occupied by the vertices and tile maps of all built chunks, in bytes.
+        inline size_t GetBuiltBytes() const { return m_built_bytes; }
     private:
+        /* A field on the tile grid, i.e. whose position is a multiple
+         * of the tile size, which is the case for nearly all fields.
+         * Takes half the memory of a Field. */
+        struct GridField
+        {
+            int16_t col;
+            int16_t row;
+            uint16_t tileid;
+        };
+
+        struct Chunk
+        {
+            sf::FloatRect bounds; // Ground-local, covers all fields
+            int first_col; // Grid position of the chunk's top-left cell
+            int first_row;
+            std::vector<uint16_t> tiles; // Dense chunks: tile ID per cell, row-major
+            size_t tile_count;           // Dense chunks: cells in `tiles` that are not EMPTY_CELL
+            std::vector<GridField> grid_fields; // Sparse chunks: ordered by row, then column
+            std::vector<Field> free_fields; // Fields that cannot be put on the grid; removed ones have NO_TILE
+            std::vector<size_t> unused_free_fields; // Indices of removed entries in `free_fields`
+            bool built;
+            sf::VertexArray vertices; // Quads of all fields not in `p_tilemap`
+            std::shared_ptr<sf::Texture> p_tilemap; // `tiles` as a texture for the tilemap shader
+
+            // Where the fields' quads are in `vertices`, for editing
+            std::vector<int32_t> cell_quads;       // Per cell of `tiles`, -1 if none
+            std::vector<int32_t> free_field_quads; // Per entry of `free_fields`, -1 if none
+            std::vector<int32_t> unused_quads;     // Quads of removed fields
+
+#ifdef TSC_HAVE_VERTEX_BUFFER
+            mutable std::shared_ptr<sf::VertexBuffer> p_buffer; // Created on drawing
+            mutable size_t dirty_first = 0; // Range of `vertices` not yet uploaded to `p_buffer`
+            mutable size_t dirty_end = 0;
+#endif
+        };
+
+        static const uint16_t EMPTY_CELL = 0xFFFF;
+
         virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
         void LoadSettingsFile(const std::string& path);
-        void ReadVertices(const std::vector<Field>& fields, const sf::Image& img);
+        bool LoadBinarySettingsFile(const Pathie::Path& path, const Pathie::Path& tileset_path, const Pathie::Path& settings_path);
+        void SplitIntoChunks(const Field* p_fields, size_t count);
+        std::vector<Field> CollectFields() const;
+        bool PackField(const Field& field, GridField& packed) const;
+        static bool GridFieldLess(const GridField& a, const GridField& b);
+        void FillVertices(Chunk& chunk, bool use_tilemap) const;
+        int FindChunk(int col, int row) const;
+        size_t CreateChunk(int col, int row, const sf::FloatRect& bounds);
+        void MakeDense(size_t index);
+        void CheckTileID(int tileid) const;
+        int32_t AllocateQuad(Chunk& chunk);
+        void FreeQuad(Chunk& chunk, int32_t quad) const;
+        void WriteQuad(Chunk& chunk, int32_t quad, float x, float y, int tileid) const;
+        void MarkDirty(const Chunk& chunk, size_t first, size_t count) const;
+        void RecordVertices(DrawList& list, const sf::RenderStates& states, const Chunk& chunk) const;
+        bool CreateTilemap(Chunk& chunk) const;
+        void RecordTilemap(DrawList& list, sf::RenderStates states, const Chunk& chunk) const;
+        size_t GetChunkBytes(const Chunk& chunk) const;
 
+        std::string m_tileset;
         int m_rows;
         int m_cols;
-        sf::VertexArray m_vertices;
-        sf::Texture m_tileset;
+        int m_tilewidth;
+        int m_tileheight;
+        int m_chunk_cols; // Size of a chunk in tiles
+        int m_chunk_rows;
+        std::vector<Chunk> m_chunks;
+        std::vector<int> m_chunk_grid; // Chunk index per chunk position, or -1
+        sf::Vector2i m_chunk_grid_origin; // Chunk position of m_chunk_grid[0]
+        int m_chunk_grid_width;
+        sf::FloatRect m_bounds; // Ground-local, covers all chunks
+        size_t m_built_bytes;
+        const sf::Texture* mp_tileset; // Owned by the TextureCache
+        std::vector<sf::Vector2f> m_tile_texcoords; // Top-left texture coordinate, indexed by tile ID
         std::vector<sf::FloatRect> m_colrects;
+        std::vector<ColrectRange> m_tile_colrects; // Indexed by tile ID
     };
 
 }
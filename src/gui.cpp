@@ -25,6 +25,7 @@
 #define NK_IMPLEMENTATION
 #include "gui.hpp"
 #include "pathmap.hpp"
+#include "draw_list.hpp"
 #include <pathie/path.hpp>
 #include <SFML/Graphics.hpp>
 
@@ -111,6 +112,7 @@ static enum nk_keys SFKey2NKKey(sf::Keyboard::Key key)
 static float CalculateGUIFontWidth(nk_handle, float, const char* text, int textlen)
 {
     sf::Text sftext(std::string(text, textlen), GUI::NormalFont, TSC::GUI::NORMAL_FONT_SIZE);
+    std::unique_lock<std::mutex> lock(DrawList::LockFonts()); // Measuring may load glyphs
     return sftext.getLocalBounds().width;
 }
 
@@ -219,13 +221,13 @@ void GUI::ProcessEvent(sf::Event& event, int xdiff, int ydiff)
 /**
  * Draws the GUI using nuklear. This function translates each command
  * in the nuklear rendering pipeline to the corresponding SFML
- * commands, if any.
+ * vertices or drawables, if any, and adds them to `list`.
  *
  * Call this once in the mainloop, after ProcessEvents().
  *
  * \see ProcessEvent()
  */
-void GUI::Draw(sf::RenderTarget& window)
+void GUI::Draw(DrawList& list)
 {
     if (!s_gui_enabled) {
         // Frame clearing is still required, otherwise nuklear gets confused.
@@ -234,9 +236,12 @@ void GUI::Draw(sf::RenderTarget& window)
     }
 
     const struct nk_command *p_cmd = nullptr;
+    float depth = list.GetDepth();
 
     nk_foreach(p_cmd, &s_gui_context) {
         sf::Color color;
+        list.SetDepth(depth++); // Windows overlap, so keep nuklear's order
+
         switch (p_cmd->type) {
         case NK_COMMAND_NOP:
             break;
@@ -248,19 +253,19 @@ void GUI::Draw(sf::RenderTarget& window)
             color = NKColor2SFColor(l->color);
             sf::Vertex line[] = {sf::Vertex(sf::Vector2f(l->begin.x, l->begin.y), color),
                                  sf::Vertex(sf::Vector2f(l->end.x, l->end.y), color)};
-            window.draw(line, 2, sf::Lines);
+            list.AddVertices(line, 2, sf::Lines);
             // TODO: Line thickness
 
         } break;
         case NK_COMMAND_POLYLINE: {
             // "Polyline" = Multiple lines after one another joined
             const struct nk_command_polyline* p = (const struct nk_command_polyline*) p_cmd;
-            sf::VertexArray polyline(sf::LineStrip, p->point_count);
+            std::vector<sf::Vertex> polyline(p->point_count);
             for (int i=0; i < p->point_count; i++) {
                 polyline[i].position = sf::Vector2f(p->points[i].x, p->points[i].y);
                 polyline[i].color = NKColor2SFColor(p->color);
             }
-            window.draw(polyline);
+            list.AddVertices(polyline.data(), polyline.size(), sf::LineStrip);
             // TODO: Line thickness
         } break;
         case NK_COMMAND_RECT: {
@@ -272,7 +277,7 @@ void GUI::Draw(sf::RenderTarget& window)
             rect.setOutlineThickness(r->line_thickness);
             rect.setFillColor(sf::Color::Transparent);
             // TODO: Round corners: r->rounding
-            window.draw(rect);
+            list.AddDrawable(rect);
         } break;
         case NK_COMMAND_RECT_FILLED: {
             const struct nk_command_rect_filled* r = (const struct nk_command_rect_filled*) p_cmd;
@@ -281,7 +286,7 @@ void GUI::Draw(sf::RenderTarget& window)
             rect.setSize(sf::Vector2f(r->w, r->h));
             rect.setFillColor(NKColor2SFColor(r->color));
             // TODO: Round corners: r->rounding
-            window.draw(rect);
+            list.AddDrawable(rect);
         } break;
         case NK_COMMAND_CIRCLE: {
             // nuklear describes a circle as top-left corner plus width/height as if it were a rectangle
@@ -293,7 +298,7 @@ void GUI::Draw(sf::RenderTarget& window)
             circle.setOutlineColor(NKColor2SFColor(c->color));
             circle.setOutlineThickness(c->line_thickness);
             circle.setFillColor(sf::Color::Transparent);
-            window.draw(circle);
+            list.AddDrawable(circle);
         } break;
         case NK_COMMAND_CIRCLE_FILLED: {
             const struct nk_command_circle_filled* c = (const struct nk_command_circle_filled*) p_cmd;
@@ -302,7 +307,7 @@ void GUI::Draw(sf::RenderTarget& window)
             circle.setPosition(c->x, c->y);
             circle.setRadius(radius);
             circle.setFillColor(NKColor2SFColor(c->color));
-            window.draw(circle);
+            list.AddDrawable(circle);
         } break;
         case NK_COMMAND_TRIANGLE: {
             const struct nk_command_triangle* t = (const struct nk_command_triangle*) p_cmd;
@@ -313,7 +318,7 @@ void GUI::Draw(sf::RenderTarget& window)
             triangle.setOutlineColor(NKColor2SFColor(t->color));
             triangle.setOutlineThickness(t->line_thickness);
             triangle.setFillColor(sf::Color::Transparent);
-            window.draw(triangle);
+            list.AddDrawable(triangle);
         } break;
         case NK_COMMAND_TRIANGLE_FILLED: {
             const struct nk_command_triangle_filled* t = (const struct nk_command_triangle_filled*) p_cmd;
@@ -322,7 +327,7 @@ void GUI::Draw(sf::RenderTarget& window)
             triangle.setPoint(1, sf::Vector2f(t->b.x, t->b.y));
             triangle.setPoint(2, sf::Vector2f(t->c.x, t->c.y));
             triangle.setFillColor(NKColor2SFColor(t->color));
-            window.draw(triangle);
+            list.AddDrawable(triangle);
         } break;
         case NK_COMMAND_POLYGON: {
             const struct nk_command_polygon* p = (const struct nk_command_polygon*) p_cmd;
@@ -333,7 +338,7 @@ void GUI::Draw(sf::RenderTarget& window)
             polygon.setOutlineColor(NKColor2SFColor(p->color));
             polygon.setOutlineThickness(p->line_thickness);
             polygon.setFillColor(sf::Color::Transparent);
-            window.draw(polygon);
+            list.AddDrawable(polygon);
         } break;
         case NK_COMMAND_POLYGON_FILLED: {
             const struct nk_command_polygon* p = (const struct nk_command_polygon*) p_cmd;
@@ -342,7 +347,7 @@ void GUI::Draw(sf::RenderTarget& window)
                 polygon.setPoint(i, sf::Vector2f(p->points[i].x, p->points[i].y));
             }
             polygon.setFillColor(NKColor2SFColor(p->color));
-            window.draw(polygon);
+            list.AddDrawable(polygon);
         } break;
         case NK_COMMAND_TEXT: {
             const struct nk_command_text* t = (const struct nk_command_text*) p_cmd;
@@ -351,7 +356,7 @@ void GUI::Draw(sf::RenderTarget& window)
             sf::Text text(sf::String::fromUtf8(utf8str.begin(), utf8str.end()), *p_font, TSC::GUI::NORMAL_FONT_SIZE);
             text.setFillColor(NKColor2SFColor(t->foreground));
             text.setPosition(sf::Vector2f(t->x, t->y));
-            window.draw(text);
+            list.AddDrawable(text);
         } break;
         case NK_COMMAND_CURVE:
             // FIXME: SFML does not support splines
@@ -65,6 +65,9 @@ namespace sf {
 
 namespace TSC {
 
+    // forward-declare
+    class DrawList;
+
     /**
      * This namespace contains the GUI system, i.e. the in-game system for the menus and such.
      * It doesn't have anything to do with setting up the game window itself, that falls into
@@ -89,7 +92,7 @@ namespace TSC {
         void Init();
         void Cleanup();
         void ProcessEvent(sf::Event& event, int xdiff, int ydiff);
-        void Draw(sf::RenderTarget& window);
+        void Draw(DrawList& list);
 
         nk_context* Get();
 
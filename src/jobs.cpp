@@ -0,0 +1,366 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "jobs.hpp"
+#include "util.hpp"
+#include <SFML/System/Clock.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace TSC;
+using namespace std;
+
+namespace {
+    struct Job
+    {
+        const char* name;
+        function<void()> func;
+        Jobs::Counter* p_counter;
+    };
+
+    // Decreases a job's counter when leaving the scope, however that happens
+    struct CounterRelease
+    {
+        Jobs::Counter* p_counter;
+        ~CounterRelease();
+    };
+
+    // Job queue of one thread
+    struct Queue
+    {
+        mutex lock;
+        deque<Job> jobs;
+    };
+}
+
+/* Queue 0 is shared by all threads that are not workers, queue N
+ * belongs to worker N. Workers take jobs from the back of their own
+ * queue and steal from the front of the others. */
+static vector<unique_ptr<Queue>> s_queues;
+static vector<thread> s_workers;
+static thread_local unsigned int t_queue = 0;
+
+/* Idle workers and threads in Jobs::Wait() sleep on s_wake_cond.
+ * s_queued is only increased with s_wake_mutex held so that no wakeup
+ * is lost, and the same goes for a counter reaching zero. */
+static mutex s_wake_mutex;
+static condition_variable s_wake_cond;
+static atomic<long> s_queued(0); // May briefly be negative
+static bool s_shutdown = false;
+
+static mutex s_init_mutex;
+static atomic<bool> s_started(false);
+static bool s_single_thread = false;
+
+static atomic<Jobs::ProfileHook> s_profile_hook(nullptr);
+static sf::Clock s_clock;
+
+CounterRelease::~CounterRelease()
+{
+    if (p_counter && --p_counter->pending == 0) {
+        // Wait() checks the counter with the mutex held
+        { lock_guard<mutex> lock(s_wake_mutex); }
+        s_wake_cond.notify_all();
+    }
+}
+
+// Runs a job and does the bookkeeping around it.
+static void run(Job& job)
+{
+    CounterRelease release{job.p_counter};
+    Jobs::ProfileHook hook = s_profile_hook.load();
+    sf::Time start = hook ? s_clock.getElapsedTime() : sf::Time::Zero;
+
+    try {
+        job.func();
+    }
+    catch (const exception& e) {
+        warn(format("Job '%s' failed: %s", job.name, e.what()));
+    }
+    catch (...) {
+        // E.g. Xerces exceptions, which do not derive from std::exception
+        warn(format("Job '%s' failed with an unknown exception", job.name));
+    }
+
+    if (hook)
+        hook(Jobs::JobProfile{job.name, t_queue, start, s_clock.getElapsedTime() - start});
+}
+
+/* Takes a job from the queue of the calling thread or, if there is
+ * none, steals one from another queue. */
+static bool take_job(Job& job)
+{
+    {
+        Queue& own = *s_queues[t_queue];
+        lock_guard<mutex> lock(own.lock);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            s_queued--;
+            return true;
+        }
+    }
+
+    for (size_t i=1; i < s_queues.size(); i++) {
+        Queue& other = *s_queues[(t_queue + i) % s_queues.size()];
+        lock_guard<mutex> lock(other.lock);
+        if (!other.jobs.empty()) {
+            job = std::move(other.jobs.front());
+            other.jobs.pop_front();
+            s_queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Runs one queued job, if there is any.
+static bool run_one()
+{
+    Job job;
+    if (!take_job(job))
+        return false;
+
+    run(job);
+    return true;
+}
+
+static void worker_main(unsigned int index)
+{
+    t_queue = index;
+
+    while (true) {
+        if (run_one())
+            continue;
+
+        unique_lock<mutex> lock(s_wake_mutex);
+        s_wake_cond.wait(lock, []{ return s_shutdown || s_queued > 0; });
+        if (s_shutdown)
+            return;
+    }
+}
+
+// Sets everything up; s_init_mutex must be held.
+static void start(int workers)
+{
+    if (workers < 0)
+        workers = max(1, static_cast<int>(thread::hardware_concurrency()) - 1);
+
+    s_single_thread = workers == 0;
+    s_shutdown = false;
+    s_clock.restart();
+
+    for (int i=0; i <= workers; i++)
+        s_queues.emplace_back(new Queue());
+
+    for (int i=1; i <= workers; i++)
+        s_workers.emplace_back(worker_main, i);
+
+    s_started = true;
+}
+
+// Starts with the default number of workers if that has not happened yet.
+static void ensure_started()
+{
+    if (s_started)
+        return;
+
+    lock_guard<mutex> lock(s_init_mutex);
+    if (!s_started)
+        start(-1);
+}
+
+/**
+ * Starts `workers` worker threads. If `workers` is negative, there is
+ * one worker per CPU core except for one; if it is zero, all jobs run
+ * on the thread submitting them (see the namespace docs). The job
+ * system is started with the default automatically when it is first
+ * used, so this only needs to be called to change the number of
+ * workers. Must not be called while jobs are running.
+ */
+void Jobs::Init(int workers)
+{
+    lock_guard<mutex> lock(s_init_mutex);
+    if (s_started)
+        Cleanup();
+
+    start(workers);
+}
+
+/**
+ * Stops the worker threads after they finished their current job.
+ * Jobs still queued are discarded. Call this at the end of the
+ * programme.
+ */
+void Jobs::Cleanup()
+{
+    {
+        lock_guard<mutex> lock(s_wake_mutex);
+        s_shutdown = true;
+    }
+    s_wake_cond.notify_all();
+
+    for (thread& worker: s_workers)
+        worker.join();
+
+    s_workers.clear();
+    s_queues.clear();
+    s_queued  = 0;
+    s_started = false;
+}
+
+// Joins the workers at exit if Cleanup() has not been called
+static struct CleanupAtExit
+{
+    ~CleanupAtExit() { Jobs::Cleanup(); }
+} s_cleanup_at_exit;
+
+unsigned int Jobs::GetWorkerCount()
+{
+    ensure_started();
+    return static_cast<unsigned int>(s_workers.size());
+}
+
+/**
+ * Queues `job` to be run by one of the workers. `name` is passed to
+ * the profile hook and must stay valid; usually it is a string
+ * literal. If `p_counter` is given, it is increased now and decreased
+ * once the job has finished, see Wait().
+ *
+ * Jobs should not throw; an exception escaping a job is shown as a
+ * warning and otherwise ignored.
+ */
+void Jobs::Submit(const char* name, function<void()> job, Counter* p_counter)
+{
+    ensure_started();
+
+    if (p_counter)
+        p_counter->pending++;
+
+    Job entry{name, std::move(job), p_counter};
+
+    if (s_single_thread) {
+        run(entry);
+        return;
+    }
+
+    {
+        Queue& queue = *s_queues[t_queue];
+        lock_guard<mutex> lock(queue.lock);
+        queue.jobs.push_back(std::move(entry));
+    }
+
+    {
+        lock_guard<mutex> lock(s_wake_mutex);
+        s_queued++;
+    }
+    s_wake_cond.notify_one();
+}
+
+/**
+ * Returns once all jobs counted by `counter` have finished. Meanwhile,
+ * the calling thread runs queued jobs itself, and sleeps if there are
+ * none left.
+ */
+void Jobs::Wait(Counter& counter)
+{
+    while (counter.pending > 0) {
+        if (run_one())
+            continue;
+
+        unique_lock<mutex> lock(s_wake_mutex);
+        s_wake_cond.wait(lock, [&]{ return counter.pending == 0 || s_queued > 0; });
+    }
+}
+
+/**
+ * Calls `func` with every index from 0 to `count` - 1, spread over
+ * all workers, and returns once all calls are done. If any call
+ * throws, the first exception is rethrown here.
+ *
+ * `func` must be safe to call from multiple threads at once.
+ */
+void Jobs::ParallelFor(const char* name, size_t count, const function<void(size_t)>& func)
+{
+    ParallelFor(name, count, 1, [&func](size_t first, size_t end) {
+            for (size_t i=first; i < end; i++)
+                func(i);
+        });
+}
+
+/**
+ * Like ParallelFor() above, but hands the indices to `func` in
+ * batches of up to `batch` as the half-open range [first, end). Use
+ * this if a single call would be too little work to be worth a job;
+ * if `count` does not exceed `batch`, `func` is simply called on the
+ * calling thread.
+ */
+void Jobs::ParallelFor(const char* name, size_t count, size_t batch, const function<void(size_t, size_t)>& func)
+{
+    if (count == 0)
+        return;
+
+    batch = max<size_t>(batch, 1);
+    if (count <= batch) {
+        func(0, count);
+        return;
+    }
+
+    Counter counter;
+    exception_ptr p_error;
+    mutex error_mutex;
+
+    for (size_t first=0; first < count; first += batch) {
+        size_t end = min(first + batch, count);
+
+        Submit(name, [&, first, end]() {
+                try {
+                    func(first, end);
+                }
+                catch (...) {
+                    lock_guard<mutex> lock(error_mutex);
+                    if (!p_error)
+                        p_error = current_exception();
+                }
+            }, &counter);
+    }
+
+    Wait(counter);
+
+    if (p_error)
+        rethrow_exception(p_error);
+}
+
+/**
+ * Sets the function to call after each job, or disables profiling if
+ * `hook` is nullptr. The hook is called on the thread that ran the
+ * job, so it has to be thread-safe.
+ */
+void Jobs::SetProfileHook(ProfileHook hook)
+{
+    s_profile_hook = hook;
+}
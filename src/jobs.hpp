@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_JOBS_HPP
+#define TSC_JOBS_HPP
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <SFML/System/Time.hpp>
+
+namespace TSC {
+
+    /**
+     * The job system runs small pieces of work (*jobs*) on a fixed pool
+     * of worker threads, one per CPU core except for the one the main
+     * loop runs on. Each worker has its own queue of jobs. Jobs submitted
+     * by a worker go into its own queue, which it works through newest
+     * first; a worker whose queue is empty steals the oldest jobs from
+     * the other queues. Jobs submitted from other threads, like the main
+     * thread, go into a shared queue that the workers steal from as well.
+     *
+     * Submit() queues a single job, ParallelFor() spreads a loop over
+     * all workers and returns when it is done. Waiting threads run
+     * queued jobs themselves and only sleep once the queues are empty.
+     * Jobs must not touch the graphics card, as OpenGL is only used
+     * from the main thread and the render thread.
+     *
+     * With zero workers (see Init()), every job runs right away on the
+     * thread that submits it, in the order of submission. This makes
+     * problems reproducible and lets debuggers and profilers show a
+     * single thread.
+     *
+     * A profile hook set with SetProfileHook() is called after each
+     * job with its name, thread and timing, e.g. to show the jobs of a
+     * frame on a timeline.
+     */
+    namespace Jobs {
+        /// Number of unfinished jobs, see Submit() and Wait().
+        struct Counter
+        {
+            Counter()
+                : pending(0) {}
+
+            std::atomic<unsigned int> pending;
+        };
+
+        /// Passed to the profile hook after a job has run.
+        struct JobProfile
+        {
+            const char* name;
+            unsigned int thread; // 0 for threads other than the workers
+            sf::Time start;      // Since Init()
+            sf::Time duration;
+        };
+
+        typedef void (*ProfileHook)(const JobProfile& profile);
+
+        void Init(int workers);
+        void Cleanup();
+        unsigned int GetWorkerCount();
+
+        void Submit(const char* name, std::function<void()> job, Counter* p_counter = nullptr);
+        void Wait(Counter& counter);
+        void ParallelFor(const char* name, size_t count, const std::function<void(size_t)>& func);
+        void ParallelFor(const char* name, size_t count, size_t batch, const std::function<void(size_t, size_t)>& func);
+
+        void SetProfileHook(ProfileHook hook);
+    };
+
+}
+
+#endif /* TSC_JOBS_HPP */
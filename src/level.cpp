@@ -1,39 +1,274 @@
 #include "level.hpp"
+#include "jobs.hpp"
 #include "pathmap.hpp"
+#include "render_stats.hpp"
+#include "settings.hpp"
+#include "texture_cache.hpp"
+#include "util.hpp"
 #include "xml_loaders/level_loader.hpp"
+#include "arena.hpp"
+#include "entities/systems.hpp"
 #include "xerces_helpers.hpp"
 #include <xercesc/sax2/XMLReaderFactory.hpp>
 #include <xercesc/framework/LocalFileInputSource.hpp>
+#include <xercesc/sax/SAXParseException.hpp>
+#include <xercesc/util/XMLException.hpp>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 
 using namespace TSC;
 using namespace std;
 
+/* First block of the arena used while loading. Levels easily have
+ * tens of thousands of fields at 12 bytes each. */
+static const size_t LOADER_ARENA_BLOCK_SIZE = 1024 * 1024;
+
 Level::Level(const std::string& relfilename)
+    : m_relfilename(relfilename),
+      m_path(Pathmap::GetLevelPath(relfilename))
 {
     using namespace xercesc;
 
-    SAX2XMLReader* p_reader = XMLReaderFactory::createXMLReader();
+    unique_ptr<SAX2XMLReader> p_reader(XMLReaderFactory::createXMLReader());
     p_reader->setFeature(XMLUni::fgSAX2CoreValidation, false);
 
-    LevelLoader handler(*this);
+    /* The loader's scratch data, most notably the fields, is only
+     * needed until the grounds are set up. It is freed all at once
+     * when the arena goes out of scope. */
+    Arena arena(LOADER_ARENA_BLOCK_SIZE);
+    LevelLoader handler(*this, arena);
     p_reader->setContentHandler(&handler);
     p_reader->setErrorHandler(&handler);
 
-    LocalFileInputSource source(U2X(Pathmap::GetLevelPath(relfilename).utf8_str()));
+    LocalFileInputSource source(U2X(m_path.utf8_str()));
     p_reader->parse(source);
+    LoadGrounds(handler);
+
+    m_camera.SetLimits(sf::FloatRect(0, 0, m_width, m_height));
+    m_camera.SetScrollSpeed(m_fixed_cam_speed);
 }
 
 Level::~Level()
 {
 }
 
-void Level::Update()
+/* Time per frame that may be spent on building chunks that are
+ * not yet visible. Visible chunks are always built immediately. */
+static const sf::Time PREFETCH_TIME_BUDGET = sf::milliseconds(2);
+
+namespace {
+    // A chunk of one of the level's grounds
+    struct ChunkRef
+    {
+        size_t ground;
+        size_t chunk;
+        float distance;
+    };
+
+    // Distance between two rectangles; zero if they intersect.
+    float rect_distance(const sf::FloatRect& a, const sf::FloatRect& b)
+    {
+        float dx = max(0.0f, max(a.left - (b.left + b.width),  b.left - (a.left + a.width)));
+        float dy = max(0.0f, max(a.top  - (b.top  + b.height), b.top  - (a.top  + a.height)));
+        return sqrt(dx * dx + dy * dy);
+    }
+}
+
+/**
+ * Sets up the grounds created by the level loader with the tilesets
+ * and fields it collected. Everything that does not need the graphics
+ * card runs concurrently for all grounds: the tileset images are
+ * decoded by the TextureCache's threads while the metadata is loaded,
+ * and the fields of all grounds are split into chunks at once. Only
+ * the texture uploads happen one after another on this thread.
+ */
+void Level::LoadGrounds(LevelLoader& loader)
+{
+    const vector<string>& tilesets = loader.ground_tilesets;
+    vector<string> textures;
+    for (const string& tileset: tilesets)
+        textures.push_back("tilesets/" + tileset);
+
+    TextureCache::Preload(textures);
+
+    Jobs::ParallelFor("Ground::LoadTilesetMetadata", m_grounds.size(), [&](size_t i) {
+            m_grounds[i].LoadTilesetMetadata(tilesets[i]);
+        });
+
+    for (Ground& ground: m_grounds)
+        ground.LoadTilesetTexture();
+
+    Jobs::ParallelFor("Ground::SetFields", m_grounds.size(), [&](size_t i) {
+            const LevelLoader::FieldList& fields = loader.ground_fields[i];
+            m_grounds[i].SetFields(fields.data(), fields.size());
+        });
+}
+
+/**
+ * Reacts on the file `path` having been changed on disk. If it is the
+ * level file itself, the whole level is loaded again. If it is the
+ * image or metadata of a tileset, only the grounds using that tileset
+ * are set up again. Other files are ignored. If loading fails, e.g.
+ * because the file is not yet completely written, a warning is shown
+ * and the level stays as it was (as far as possible).
+ */
+void Level::ReloadFile(const Pathie::Path& path)
+{
+    try {
+        if (path == m_path) {
+            Reload();
+            return;
+        }
+
+        string tilesets = (Pathmap::GetPixmapsPath() / "tilesets").utf8_str() + "/";
+        string str      = path.utf8_str();
+        if (str.compare(0, tilesets.size(), tilesets) != 0)
+            return;
+
+        // The image, XML and binary metadata of a tileset only differ in the extension
+        Pathie::Path tileset = Pathie::Path(str.substr(tilesets.size())).sub_ext(".png");
+        for (Ground& ground: m_grounds) {
+            if (Pathie::Path(ground.GetTileset()).sub_ext(".png") == tileset)
+                ground.ReloadTileset();
+        }
+    }
+    catch (const xercesc::SAXParseException& e) {
+        warn(format("Failed to reload '%s': %s", path.utf8_str().c_str(), X2U(e.getMessage()).c_str()));
+    }
+    catch (const xercesc::XMLException& e) {
+        warn(format("Failed to reload '%s': %s", path.utf8_str().c_str(), X2U(e.getMessage()).c_str()));
+    }
+    catch (const exception& e) {
+        warn(format("Failed to reload '%s': %s", path.utf8_str().c_str(), e.what()));
+    }
+}
+
+/* Loads the level file again. The new level is loaded completely
+ * before anything is replaced, so that this level is left alone if
+ * it fails. Tileset textures come from the TextureCache and thus do
+ * not have to be loaded again. The camera keeps its position. */
+void Level::Reload()
+{
+    Level fresh(m_relfilename);
+
+    m_width           = fresh.m_width;
+    m_height          = fresh.m_height;
+    m_fixed_cam_speed = fresh.m_fixed_cam_speed;
+    m_music           = fresh.m_music;
+    m_grounds.swap(fresh.m_grounds);
+    swap(m_registry, fresh.m_registry);
+
+    m_camera.SetLimits(sf::FloatRect(0, 0, m_width, m_height));
+    m_camera.SetScrollSpeed(m_fixed_cam_speed);
+}
+
+/**
+ * Updates the level for the next frame. `elapsed` is the time the
+ * last frame took in seconds. The objects are updated by the systems
+ * (see systems.hpp) before the camera moves.
+ */
+void Level::Update(float elapsed)
 {
+    Systems::ApplyGravity(m_registry, elapsed);
+    Systems::Move(m_registry, elapsed);
+
+    m_camera.Update(elapsed);
+    StreamChunks(m_camera.GetVisibleArea());
 }
 
-void Level::Draw(sf::RenderTarget& stage) const
+/**
+ * Builds and releases ground chunks depending on their distance to
+ * the `visible` area of the level:
+ *
+ * 1. Visible chunks are built right away on all CPU cores, as they
+ *    are needed for drawing this frame.
+ * 2. Chunks within Settings::level_prefetch_distance of the visible
+ *    area are built nearest first, but only until PREFETCH_TIME_BUDGET
+ *    is used up; the rest is left for the next frames. This way, the
+ *    chunks are usually ready when the camera reaches them.
+ * 3. If the built chunks occupy more than Settings::level_memory_budget,
+ *    the non-visible chunks farthest away are released until the
+ *    budget is met again.
+ *
+ * Only the chunks' vertices are paged in and out; the fields are
+ * always kept in memory.
+ */
+void Level::StreamChunks(const sf::FloatRect& visible)
 {
-    for (const Ground& ground: m_grounds) {
-        stage.draw(ground);
+    float prefetch_distance = static_cast<float>(Settings::level_prefetch_distance);
+    size_t memory_budget    = static_cast<size_t>(Settings::level_memory_budget) * 1024 * 1024;
+    size_t built_bytes      = 0;
+    vector<ChunkRef> prefetch;
+    vector<ChunkRef> built;
+
+    vector<size_t> visible_chunks;
+
+    for (size_t g=0; g < m_grounds.size(); g++) {
+        Ground& ground = m_grounds[g];
+        visible_chunks.clear();
+
+        for (size_t c=0; c < ground.GetChunkCount(); c++) {
+            float distance = rect_distance(ground.GetChunkBounds(c), visible);
+
+            if (distance == 0.0f)
+                visible_chunks.push_back(c);
+            else if (ground.IsChunkBuilt(c))
+                built.push_back(ChunkRef{g, c, distance});
+            else if (distance <= prefetch_distance)
+                prefetch.push_back(ChunkRef{g, c, distance});
+        }
+
+        ground.BuildChunks(visible_chunks);
+        built_bytes += ground.GetBuiltBytes();
+    }
+
+    sort(prefetch.begin(), prefetch.end(), [](const ChunkRef& a, const ChunkRef& b){ return a.distance < b.distance; });
+
+    sf::Clock clock;
+    for (const ChunkRef& ref: prefetch) {
+        if (clock.getElapsedTime() >= PREFETCH_TIME_BUDGET)
+            break;
+
+        built_bytes += m_grounds[ref.ground].BuildChunk(ref.chunk);
     }
+
+    if (built_bytes <= memory_budget)
+        return;
+
+    sort(built.begin(), built.end(), [](const ChunkRef& a, const ChunkRef& b){ return a.distance > b.distance; });
+
+    for (const ChunkRef& ref: built) {
+        if (built_bytes <= memory_budget)
+            break;
+
+        built_bytes -= m_grounds[ref.ground].ReleaseChunk(ref.chunk);
+    }
+}
+
+/**
+ * Draws the level as seen by its camera. Grounds that are entirely
+ * outside of the camera's view are skipped.
+ */
+void Level::Draw(DrawList& list) const
+{
+    sf::View previous_view = list.GetView();
+    float previous_depth   = list.GetDepth();
+    sf::FloatRect visible  = m_camera.GetVisibleArea();
+
+    list.SetView(m_camera.GetView());
+
+    // Later grounds are drawn on top of earlier ones
+    for (size_t i=0; i < m_grounds.size(); i++) {
+        if (m_grounds[i].GetBounds().intersects(visible)) {
+            list.SetDepth(previous_depth + i);
+            m_grounds[i].Record(list);
+        }
+        else {
+            RenderStats::CountCulledGround();
+        }
+    }
+
+    list.SetView(previous_view);
+    list.SetDepth(previous_depth);
 }
@@ -2,7 +2,10 @@
 #define TSC_LEVEL_HPP
 #include <string>
 #include <vector>
+#include <pathie/path.hpp>
+#include "camera.hpp"
 #include "ground.hpp"
+#include "entities/registry.hpp"
 
 namespace TSC {
 
@@ -15,14 +18,32 @@ namespace TSC {
         Level(const std::string& relfilename);
         ~Level();
 
-        void Update();
-        void Draw(sf::RenderTarget& stage) const;
+        void ReloadFile(const Pathie::Path& path);
+        void Update(float elapsed);
+        void Draw(DrawList& list) const;
+
+        inline int GetWidth() const { return m_width; }
+        inline int GetHeight() const { return m_height; }
+        inline Camera& GetCamera() { return m_camera; }
+        inline const Camera& GetCamera() const { return m_camera; }
+        /// All objects of the level other than the grounds.
+        inline Registry& GetRegistry() { return m_registry; }
+        /// For editing; the number of grounds must not be changed.
+        inline std::vector<Ground>& GetGrounds() { return m_grounds; }
     private:
+        void Reload();
+        void LoadGrounds(LevelLoader& loader);
+        void StreamChunks(const sf::FloatRect& visible);
+
+        std::string m_relfilename;
+        Pathie::Path m_path;
         int m_width;
         int m_height;
         int m_fixed_cam_speed;
         std::string m_music;
         std::vector<Ground> m_grounds;
+        Registry m_registry;
+        Camera m_camera;
     };
 
 }
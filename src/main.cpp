@@ -19,7 +19,9 @@
  ******************************************************************************/
 
 #include "application.hpp"
+#include <iostream>
 #include <locale>
+#include <stdexcept>
 
 using namespace TSC;
 using namespace std;
@@ -27,6 +29,12 @@ using namespace std;
 /// Entry point to the programme.
 int main(int argc, char* argv[])
 {
-    Application app(argc, argv);
-    return app.MainLoop();
+    try {
+        Application app(argc, argv);
+        return app.MainLoop();
+    }
+    catch (const runtime_error& err) {
+        cerr << "Error: " << err.what() << endl;
+        return 1;
+    }
 }
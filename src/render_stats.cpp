@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "render_stats.hpp"
+
+using namespace TSC;
+
+static unsigned int s_draw_calls = 0;
+static unsigned int s_state_changes = 0;
+static unsigned int s_culled_grounds = 0;
+
+/// Resets all counters. Call this at the start of a frame.
+void RenderStats::BeginFrame()
+{
+    s_draw_calls = 0;
+    s_state_changes = 0;
+    s_culled_grounds = 0;
+}
+
+/// Records that `count` draw calls were issued to SFML.
+void RenderStats::CountDrawCall(unsigned int count)
+{
+    s_draw_calls += count;
+}
+
+/// Returns the number of draw calls issued since BeginFrame().
+unsigned int RenderStats::GetDrawCalls()
+{
+    return s_draw_calls;
+}
+
+/// Records that the texture, shader or view changed `count` times.
+void RenderStats::CountStateChange(unsigned int count)
+{
+    s_state_changes += count;
+}
+
+/// Returns the number of state changes since BeginFrame().
+unsigned int RenderStats::GetStateChanges()
+{
+    return s_state_changes;
+}
+
+/// Records that `count` grounds were not drawn as they are not visible.
+void RenderStats::CountCulledGround(unsigned int count)
+{
+    s_culled_grounds += count;
+}
+
+/// Returns the number of grounds culled since BeginFrame().
+unsigned int RenderStats::GetCulledGrounds()
+{
+    return s_culled_grounds;
+}
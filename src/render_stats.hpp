@@ -0,0 +1,46 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_RENDER_STATS_HPP
+#define TSC_RENDER_STATS_HPP
+
+namespace TSC {
+
+    /**
+     * Counters for the work done by the renderer in one frame. The
+     * main loop calls BeginFrame() at the start of every frame;
+     * DrawList::Sort() counts the draw calls and changes of texture,
+     * shader or view the list will make, and Level::Draw() counts the
+     * grounds it skipped because they are outside of the view. Only
+     * use this from the main thread.
+     */
+    namespace RenderStats {
+        void BeginFrame();
+        void CountDrawCall(unsigned int count = 1);
+        unsigned int GetDrawCalls();
+        void CountStateChange(unsigned int count = 1);
+        unsigned int GetStateChanges();
+        void CountCulledGround(unsigned int count = 1);
+        unsigned int GetCulledGrounds();
+    }
+
+}
+
+#endif /* TSC_RENDER_STATS_HPP */
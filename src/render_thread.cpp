@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "render_thread.hpp"
+
+using namespace TSC;
+using namespace std;
+
+/**
+ * Starts the render thread, which takes over the OpenGL context of
+ * `window`. `present` is called on the render thread for each
+ * submitted list.
+ */
+RenderThread::RenderThread(sf::RenderWindow& window, function<void(const DrawList&)> present)
+    : m_window(window),
+      m_present(move(present)),
+      m_busy(false),
+      m_stop(false)
+{
+    // A context can only be active on one thread at a time
+    m_window.setActive(false);
+    m_thread = thread(&RenderThread::Run, this);
+}
+
+/**
+ * Stops the render thread. A frame submitted but not yet drawn is
+ * dropped. The window's context is not active on any thread then.
+ */
+RenderThread::~RenderThread()
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_cond.notify_all();
+    m_thread.join();
+}
+
+/**
+ * Hands `list` over to the render thread, after waiting for the
+ * previous frame to be finished (see Finish()). `list` is swapped
+ * with the render thread's old, empty list, so that its memory is
+ * reused for recording the next frame.
+ */
+void RenderThread::Submit(DrawList& list)
+{
+    Finish();
+
+    {
+        lock_guard<mutex> lock(m_mutex);
+        swap(m_list, list);
+        m_busy = true;
+    }
+
+    m_cond.notify_all();
+}
+
+/**
+ * Waits until the last submitted frame has been drawn and shown,
+ * and then releases the resources its list referred to. Afterwards,
+ * the main thread may change textures until the next Submit().
+ */
+void RenderThread::Finish()
+{
+    unique_lock<mutex> lock(m_mutex);
+    m_cond.wait(lock, [this]{ return !m_busy; });
+    m_list.Clear(m_list.GetView());
+}
+
+void RenderThread::Run()
+{
+    m_window.setActive(true);
+
+    unique_lock<mutex> lock(m_mutex);
+    while (true) {
+        m_cond.wait(lock, [this]{ return m_busy || m_stop; });
+        if (m_stop)
+            break;
+
+        // Drawing does not need the lock; the main thread waits for m_busy
+        lock.unlock();
+        m_present(m_list);
+        lock.lock();
+
+        m_busy = false;
+        m_cond.notify_all();
+    }
+
+    lock.unlock();
+    m_window.setActive(false);
+}
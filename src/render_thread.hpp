@@ -0,0 +1,69 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_RENDER_THREAD_HPP
+#define TSC_RENDER_THREAD_HPP
+#include "draw_list.hpp"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace TSC {
+
+    /**
+     * A thread that draws the frames recorded by the main loop. The
+     * main loop records a frame into a DrawList and hands it over
+     * with Submit(); the render thread then calls the present function
+     * given to the constructor with it, which draws the list onto the
+     * window and flips the buffers. Meanwhile, the main loop processes
+     * events and updates the next frame, so that waiting for vsync or
+     * the graphics driver does not hold up the game logic.
+     *
+     * The render thread owns the window's OpenGL context for as long
+     * as the RenderThread object exists. The main thread may still
+     * create textures, as SFML then uses a context of its own, but it
+     * must call Finish() before changing a texture a submitted list
+     * may refer to, like the TextureCache does when uploading.
+     */
+    class RenderThread
+    {
+    public:
+        RenderThread(sf::RenderWindow& window, std::function<void(const DrawList&)> present);
+        ~RenderThread();
+
+        void Submit(DrawList& list);
+        void Finish();
+    private:
+        void Run();
+
+        sf::RenderWindow& m_window;
+        std::function<void(const DrawList&)> m_present;
+        DrawList m_list; // Being drawn if m_busy
+        bool m_busy;
+        bool m_stop;
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+        std::thread m_thread;
+    };
+
+}
+
+#endif /* TSC_RENDER_THREAD_HPP */
@@ -0,0 +1,68 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "benchmark_scene.hpp"
+#include "../application.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace TSC;
+using namespace std;
+
+static const float PI = 3.14159265f;
+
+BenchmarkScene::BenchmarkScene(const string& relfilename, int frames)
+    : m_level(relfilename),
+      m_frames(frames),
+      m_frame(0)
+{
+    // The path below replaces any fixed camera speed of the level
+    m_level.GetCamera().SetScrollSpeed(0.0f);
+}
+
+BenchmarkScene::~BenchmarkScene()
+{
+}
+
+void BenchmarkScene::Update(const sf::RenderTarget&)
+{
+    if (m_frame >= m_frames) {
+        Finish();
+        return;
+    }
+
+    /* The camera position only depends on the frame number, not on
+     * the time passed, so that slow and fast machines render the
+     * very same frames. */
+    float progress = m_frames > 1 ? static_cast<float>(m_frame) / (m_frames - 1) : 0.0f;
+    float xrange   = max(0.0f, static_cast<float>(m_level.GetWidth()) - NATIVE_WIDTH);
+    float yrange   = max(0.0f, static_cast<float>(m_level.GetHeight()) - NATIVE_HEIGHT);
+    float x        = progress * xrange;
+    float y        = yrange * (0.5f - 0.5f * cos(4.0f * PI * progress));
+
+    m_level.GetCamera().SetCenter(sf::Vector2f(x + NATIVE_WIDTH / 2.0f, y + NATIVE_HEIGHT / 2.0f));
+    m_level.Update(Application::Instance()->GetFrameTime());
+    m_frame++;
+}
+
+void BenchmarkScene::Draw(DrawList& list) const
+{
+    m_level.Draw(list);
+}
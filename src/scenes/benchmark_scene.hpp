@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_BENCHMARK_SCENE_HPP
+#define TSC_BENCHMARK_SCENE_HPP
+#include <SFML/Graphics.hpp>
+#include <string>
+#include "scene.hpp"
+#include "../level.hpp"
+
+namespace TSC {
+
+    /**
+     * Scene for the headless benchmark mode (see Application). It
+     * moves the level's camera along a fixed path through the level, so that
+     * every run renders exactly the same frames, and finishes after
+     * the requested number of frames. The path goes from the left
+     * to the right edge of the level while swinging up and down
+     * twice, so that all parts of the level are visited.
+     */
+    class BenchmarkScene: public Scene
+    {
+    public:
+        BenchmarkScene(const std::string& relfilename, int frames);
+        virtual ~BenchmarkScene();
+
+        virtual void Update(const sf::RenderTarget& stage);
+        virtual void Draw(DrawList& list) const;
+    private:
+        Level m_level;
+        int m_frames;
+        int m_frame;
+    };
+
+}
+
+#endif /* TSC_BENCHMARK_SCENE_HPP */
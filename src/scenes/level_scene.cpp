@@ -1,4 +1,5 @@
 #include "level_scene.hpp"
+#include "../application.hpp"
 
 using namespace TSC;
 using namespace std;
@@ -12,6 +13,17 @@ LevelScene::~LevelScene()
 {
 }
 
+/**
+ * Returns the textures (relative to the pixmaps directory) this
+ * scene needs, so that the scene pushing it can have them preloaded
+ * via TextureCache::Preload(). Keep this in sync with the level
+ * loaded in the constructor.
+ */
+vector<string> LevelScene::GetPreloadList()
+{
+    return {"tilesets/green_3.png"};
+}
+
 void LevelScene::ProcessEvent(sf::Event& event)
 {
     Scene::ProcessEvent(event);
@@ -21,12 +33,17 @@ void LevelScene::ProcessEvent(sf::Event& event)
     }
 }
 
+void LevelScene::ReloadFile(const Pathie::Path& path)
+{
+    m_level.ReloadFile(path);
+}
+
 void LevelScene::Update(const sf::RenderTarget&)
 {
-    m_level.Update();
+    m_level.Update(Application::Instance()->GetFrameTime());
 }
 
-void LevelScene::Draw(sf::RenderTarget& stage) const
+void LevelScene::Draw(DrawList& list) const
 {
-    m_level.Draw(stage);
+    m_level.Draw(list);
 }
@@ -1,6 +1,8 @@
 #ifndef TSC_LEVEL_SCENE_HPP
 #define TSC_LEVEL_SCENE_HPP
 #include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
 #include "scene.hpp"
 #include "../level.hpp"
 
@@ -12,11 +14,13 @@ namespace TSC {
         LevelScene();
         virtual ~LevelScene();
 
+        static std::vector<std::string> GetPreloadList();
+
         virtual void ProcessEvent(sf::Event& event);
+        virtual void ReloadFile(const Pathie::Path& path);
         virtual void Update(const sf::RenderTarget& stage);
-        virtual void Draw(sf::RenderTarget& stage) const;
+        virtual void Draw(DrawList& list) const;
     private:
-        sf::View m_view;
         Level m_level;
     };
 
@@ -26,9 +26,15 @@ namespace sf {
     class RenderTarget;
     class Event;
 }
+namespace Pathie {
+    class Path;
+}
 
 namespace TSC {
 
+    // forward-declare
+    class DrawList;
+
     /**
      * Base class for all scenes. When creating a new scene, override the virtual
      * methods provided in this class as you need.
@@ -49,10 +55,12 @@ namespace TSC {
      * At minimum, you have to override the Update() and Draw() functions.
      * The former's purpose is to update scene's internal state, e.g.
      * move enemies around. The latter's purpose is to then draw all
-     * the scene's entities in the state Update() left them in. That's
-     * also why Update() only receives a const reference to the SFML
-     * window rather than a normal one as Draw() does -- you're not supposed
-     * to mess with the drawing in Update().
+     * the scene's entities in the state Update() left them in. Draw()
+     * does not receive the SFML window, but a DrawList to record the
+     * drawing in, which the main loop then draws onto the window --
+     * possibly on the render thread while the next frame is updated.
+     * Update() only receives a const reference to the SFML window, as
+     * you're not supposed to mess with the drawing in Update().
      *
      * DoGUI() is actually a special-purpose Update() function. The GUI
      * toolkit in use, nuklear, demands that GUI drawing is done as early
@@ -148,9 +156,28 @@ namespace TSC {
          * scene stack at the beginning of the next frame.
          */
         virtual void Update(const sf::RenderTarget& stage) = 0;
-        /// Draw() shall draw the updated scene onto the screen.
+        /// Draw() shall add the updated scene to the draw list.
         /// Game logic updates should be in Update().
-        virtual void Draw(sf::RenderTarget& stage) const = 0;
+        virtual void Draw(DrawList& list) const = 0;
+
+        /**
+         * Called before Update() for each data file that has been
+         * changed on disk while this scene is active, if
+         * Settings::enable_hot_reload is set. Override this to reload
+         * the level or other files the scene uses. Textures in the
+         * TextureCache have already been reloaded at this point. Does
+         * nothing by default.
+         */
+        virtual void ReloadFile(const Pathie::Path&) {}
+
+        /**
+         * Return true from this if the scene would look the same in
+         * the next frame unless the user does something, like a menu
+         * without animations. If the user did not give any input for a
+         * moment either, the main loop then lowers the frame rate to
+         * save CPU time and power. Returns false by default.
+         */
+        virtual bool IsIdle() const { return false; }
 
         /// This function is called at the end of the main loop.
         /// You should really not use it. See the class docs
@@ -25,14 +25,22 @@
 #include "../audio.hpp"
 #include "../gui.hpp"
 #include "../application.hpp"
+#include "../draw_list.hpp"
 #include "../i18n.hpp"
 
 using namespace std;
 using namespace TSC;
 
 TitleScene::TitleScene()
+    : m_background_ready(false)
 {
-    m_background.setTexture(TextureCache::Get("misc/title.png"));
+    /* Decode the title image in the background rather than stalling
+     * the first frame; the sprite shows nothing until Update() notices
+     * that the texture has arrived. While the user is looking at the
+     * menu, the textures of the level scene are warmed up as well. */
+    TextureCache::Request("misc/title.png");
+    TextureCache::Preload(LevelScene::GetPreloadList());
+
     m_background.setPosition(sf::Vector2f(0, 0));
     m_background.setScale(Application::Instance()->GetGlobalScaleVec());
 
@@ -81,9 +89,19 @@ void TitleScene::DoGUI(const sf::RenderTarget& stage)
 
 void TitleScene::Update(const sf::RenderTarget&)
 {
+    if (!m_background_ready && TextureCache::IsReady("misc/title.png")) {
+        m_background.setTexture(TextureCache::Get("misc/title.png"), true);
+        m_background_ready = true;
+    }
+}
+
+void TitleScene::Draw(DrawList& list) const
+{
+    list.AddDrawable(m_background);
 }
 
-void TitleScene::Draw(sf::RenderTarget& stage) const
+// Nothing moves once the background is there.
+bool TitleScene::IsIdle() const
 {
-    stage.draw(m_background);
+    return m_background_ready;
 }
@@ -34,9 +34,12 @@ namespace TSC {
         virtual void ProcessEvent(sf::Event& event);
         virtual void DoGUI(const sf::RenderTarget& stage);
         virtual void Update(const sf::RenderTarget& stage);
-        virtual void Draw(sf::RenderTarget& stage) const;
+        virtual void Draw(DrawList& list) const;
+        virtual bool IsIdle() const;
 
         sf::Sprite m_background;
+    private:
+        bool m_background_ready;
     };
 
 }
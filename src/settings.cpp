@@ -39,6 +39,7 @@
 #include <xercesc/dom/DOMLSSerializer.hpp>
 #include <xercesc/dom/DOMLSOutput.hpp>
 #include <xercesc/dom/DOMConfiguration.hpp>
+#include <algorithm>
 
 using namespace TSC;
 using namespace xercesc;
@@ -50,12 +51,22 @@ int Settings::screen_width       = NATIVE_WIDTH;
 int Settings::screen_height      = NATIVE_HEIGHT;
 int Settings::music_volume       = 100;
 int Settings::sound_volume       = 100;
+int Settings::level_memory_budget     = 256;  // MiB of level geometry
+int Settings::level_prefetch_distance = 1024; // Pixels around the view
+int Settings::worker_threads          = -1;   // Job system workers; -1 = one per CPU core but one, 0 = single-threaded
+int Settings::dynamic_resolution_budget = 17; // Frame time in ms to hold with enable_dynamic_resolution
+int Settings::target_fps              = 0;    // Frame rate cap; 0 = uncapped
 
 bool Settings::enable_vsync      = false;
 bool Settings::enable_always_run = false;
 bool Settings::enable_fullscreen = true;
 bool Settings::enable_music      = true;
 bool Settings::enable_sound      = true;
+bool Settings::enable_shader_tilemap = true;
+bool Settings::enable_hot_reload     = false; // Reload changed data files, for development
+bool Settings::enable_render_thread  = false; // Draw frames on a separate thread
+bool Settings::enable_postprocessing = false; // Draw frames into a texture first, for full-screen effects
+bool Settings::enable_dynamic_resolution = false; // Lower the scene's resolution if frames are slow
 
 // This does not have a default value. It is required to be present
 // in the configuration file.
@@ -93,6 +104,16 @@ namespace {
                 Settings::enable_music = m_chars == "yes";
             else if (localname == "enable_sound")
                 Settings::enable_sound = m_chars == "yes";
+            else if (localname == "enable_shader_tilemap")
+                Settings::enable_shader_tilemap = m_chars == "yes";
+            else if (localname == "enable_hot_reload")
+                Settings::enable_hot_reload = m_chars == "yes";
+            else if (localname == "enable_render_thread")
+                Settings::enable_render_thread = m_chars == "yes";
+            else if (localname == "enable_postprocessing")
+                Settings::enable_postprocessing = m_chars == "yes";
+            else if (localname == "enable_dynamic_resolution")
+                Settings::enable_dynamic_resolution = m_chars == "yes";
             else if (localname == "music_volume") {
                 Settings::music_volume = stoi(m_chars);
                 if (Settings::music_volume < 0)
@@ -107,6 +128,16 @@ namespace {
                 else if (Settings::sound_volume > 100)
                     Settings::sound_volume = 100;
             }
+            else if (localname == "level_memory_budget")
+                Settings::level_memory_budget = max(0, stoi(m_chars));
+            else if (localname == "level_prefetch_distance")
+                Settings::level_prefetch_distance = max(0, stoi(m_chars));
+            else if (localname == "dynamic_resolution_budget")
+                Settings::dynamic_resolution_budget = max(1, stoi(m_chars));
+            else if (localname == "target_fps")
+                Settings::target_fps = max(0, stoi(m_chars));
+            else if (localname == "worker_threads")
+                Settings::worker_threads = max(-1, stoi(m_chars));
             else if (localname == "configuration") {
                 // Ignore root node
             }
@@ -212,6 +243,31 @@ void Settings::Save()
     p_child->appendChild(p_text);
     p_root->appendChild(p_child);
 
+    p_child = p_doc->createElement(U2X("level_memory_budget"));
+    p_text = p_doc->createTextNode(U2X(to_string(level_memory_budget)));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
+    p_child = p_doc->createElement(U2X("level_prefetch_distance"));
+    p_text = p_doc->createTextNode(U2X(to_string(level_prefetch_distance)));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
+    p_child = p_doc->createElement(U2X("worker_threads"));
+    p_text = p_doc->createTextNode(U2X(to_string(worker_threads)));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
+    p_child = p_doc->createElement(U2X("dynamic_resolution_budget"));
+    p_text = p_doc->createTextNode(U2X(to_string(dynamic_resolution_budget)));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
+    p_child = p_doc->createElement(U2X("target_fps"));
+    p_text = p_doc->createTextNode(U2X(to_string(target_fps)));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
     p_child = p_doc->createElement(U2X("enable_vsync"));
     p_text = p_doc->createTextNode(U2X(enable_vsync ? "yes" : "no"));
     p_child->appendChild(p_text);
@@ -237,6 +293,31 @@ void Settings::Save()
     p_child->appendChild(p_text);
     p_root->appendChild(p_child);
 
+    p_child = p_doc->createElement(U2X("enable_shader_tilemap"));
+    p_text = p_doc->createTextNode(U2X(enable_shader_tilemap ? "yes" : "no"));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
+    p_child = p_doc->createElement(U2X("enable_hot_reload"));
+    p_text = p_doc->createTextNode(U2X(enable_hot_reload ? "yes" : "no"));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
+    p_child = p_doc->createElement(U2X("enable_render_thread"));
+    p_text = p_doc->createTextNode(U2X(enable_render_thread ? "yes" : "no"));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
+    p_child = p_doc->createElement(U2X("enable_postprocessing"));
+    p_text = p_doc->createTextNode(U2X(enable_postprocessing ? "yes" : "no"));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
+    p_child = p_doc->createElement(U2X("enable_dynamic_resolution"));
+    p_text = p_doc->createTextNode(U2X(enable_dynamic_resolution ? "yes" : "no"));
+    p_child->appendChild(p_text);
+    p_root->appendChild(p_child);
+
     // Write it out to disk
     LocalFileFormatTarget target(U2X(Pathmap::GetConfigPath().utf8_str()));
     DOMLSSerializer* p_serializer = p_impl->createLSSerializer();
@@ -36,12 +36,22 @@ namespace TSC {
         extern int screen_height;
         extern int music_volume;
         extern int sound_volume;
+        extern int level_memory_budget;
+        extern int level_prefetch_distance;
+        extern int worker_threads;
+        extern int dynamic_resolution_budget;
+        extern int target_fps;
 
         extern bool enable_vsync;
         extern bool enable_always_run;
         extern bool enable_fullscreen;
         extern bool enable_music;
         extern bool enable_sound;
+        extern bool enable_shader_tilemap;
+        extern bool enable_hot_reload;
+        extern bool enable_render_thread;
+        extern bool enable_postprocessing;
+        extern bool enable_dynamic_resolution;
     };
 
 }
@@ -0,0 +1,149 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "sprite_batch.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace TSC;
+using namespace std;
+
+SpriteBatch::SpriteBatch(const sf::Texture* p_texture)
+    : mp_texture(p_texture)
+{
+}
+
+/// Sets the texture all sprites of the batch are taken from.
+void SpriteBatch::SetTexture(const sf::Texture* p_texture)
+{
+    mp_texture = p_texture;
+}
+
+/// Removes all sprites, keeping the memory for the next frame.
+void SpriteBatch::Clear()
+{
+    m_vertices.clear();
+}
+
+/// Makes room for `count` sprites without reallocating.
+void SpriteBatch::Reserve(size_t count)
+{
+    m_vertices.reserve(count * 4);
+}
+
+/**
+ * Adds a sprite showing `texrect` of the texture, unscaled and
+ * unrotated, with its top-left corner at `position`.
+ */
+void SpriteBatch::Add(const sf::Vector2f& position, const sf::IntRect& texrect, const sf::Color& color)
+{
+    sf::Vertex* p_quad = AppendQuad(texrect, color);
+    float width  = static_cast<float>(abs(texrect.width));
+    float height = static_cast<float>(abs(texrect.height));
+
+    p_quad[0].position = position;
+    p_quad[1].position = sf::Vector2f(position.x + width, position.y);
+    p_quad[2].position = sf::Vector2f(position.x + width, position.y + height);
+    p_quad[3].position = sf::Vector2f(position.x,         position.y + height);
+}
+
+/**
+ * Adds a sprite showing `texrect` of the texture, transformed like
+ * an sf::Sprite with the given transformation would be.
+ */
+void SpriteBatch::Add(const sf::Transform& transform, const sf::IntRect& texrect, const sf::Color& color)
+{
+    sf::Vertex* p_quad = AppendQuad(texrect, color);
+    float width  = static_cast<float>(abs(texrect.width));
+    float height = static_cast<float>(abs(texrect.height));
+
+    p_quad[0].position = transform.transformPoint(0.0f,  0.0f);
+    p_quad[1].position = transform.transformPoint(width, 0.0f);
+    p_quad[2].position = transform.transformPoint(width, height);
+    p_quad[3].position = transform.transformPoint(0.0f,  height);
+}
+
+/**
+ * Adds the given sprite, which must use the batch's texture. This is
+ * slower than the other variants, as sf::Sprite is rather large.
+ */
+void SpriteBatch::Add(const sf::Sprite& sprite)
+{
+    Add(sprite.getTransform(), sprite.getTextureRect(), sprite.getColor());
+}
+
+// Appends a quad with texture coordinates and colour, but no positions.
+sf::Vertex* SpriteBatch::AppendQuad(const sf::IntRect& texrect, const sf::Color& color)
+{
+    m_vertices.resize(m_vertices.size() + 4);
+    sf::Vertex* p_quad = &m_vertices[m_vertices.size() - 4];
+
+    float left   = static_cast<float>(texrect.left);
+    float top    = static_cast<float>(texrect.top);
+    float right  = left + texrect.width;
+    float bottom = top  + texrect.height;
+
+    p_quad[0].texCoords = sf::Vector2f(left,  top);
+    p_quad[1].texCoords = sf::Vector2f(right, top);
+    p_quad[2].texCoords = sf::Vector2f(right, bottom);
+    p_quad[3].texCoords = sf::Vector2f(left,  bottom);
+
+    for (int i=0; i < 4; i++)
+        p_quad[i].color = color;
+
+    return p_quad;
+}
+
+/**
+ * Adds all sprites to `list` as a single draw call with the batch's
+ * texture. Uploads the vertex buffer, so call this from the main
+ * thread.
+ */
+void SpriteBatch::Record(DrawList& list, const sf::RenderStates& states) const
+{
+    if (m_vertices.empty())
+        return;
+
+    sf::RenderStates batchstates(states);
+    batchstates.texture = mp_texture;
+
+#ifdef TSC_HAVE_VERTEX_BUFFER
+    if (sf::VertexBuffer::isAvailable()) {
+        size_t count = m_vertices.size();
+
+        // A buffer still held by a DrawList must not change under its feet
+        if (!mp_buffer || mp_buffer->getVertexCount() < count || mp_buffer.use_count() > 1) {
+            size_t capacity = mp_buffer ? max(mp_buffer->getVertexCount(), count) : count;
+            mp_buffer = make_shared<sf::VertexBuffer>(sf::Quads, sf::VertexBuffer::Stream);
+            if (!mp_buffer->create(capacity + capacity / 2)) {
+                mp_buffer.reset();
+                list.AddVertices(m_vertices.data(), count, sf::Quads, batchstates);
+                return;
+            }
+        }
+
+        mp_buffer->update(m_vertices.data(), count, 0);
+        list.AddVertexBuffer(mp_buffer, count, batchstates);
+        return;
+    }
+#endif
+
+    list.AddVertices(m_vertices.data(), m_vertices.size(), sf::Quads, batchstates);
+}
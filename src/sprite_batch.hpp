@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * This file is part of TSC.
+ *
+ * TSC is a 2-dimensional platform game.
+ * Copyright © 2018 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef TSC_SPRITE_BATCH_HPP
+#define TSC_SPRITE_BATCH_HPP
+#include "draw_list.hpp"
+#include <memory>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+namespace TSC {
+
+    /**
+     * Draws many sprites from the same texture, usually an atlas of
+     * all frames of some objects, in a single draw call. Instead of
+     * creating an sf::Sprite for each object, add the objects with
+     * their position or transformation, texture rectangle and colour
+     * each frame; the batch keeps one quad per sprite. Record() then
+     * adds all of them to a DrawList at once.
+     *
+     * With SFML 2.5 or newer, the quads are uploaded into a vertex
+     * buffer that is reused from frame to frame, unless the render
+     * thread is still drawing it, in which case a new one is made
+     * (see Ground for the same scheme). Otherwise the DrawList gets a
+     * copy of the vertices.
+     *
+     * Clear() keeps the memory of the batch, so the usual way of using
+     * it is a SpriteBatch per texture that lives as long as the scene
+     * and is cleared and refilled each frame.
+     */
+    class SpriteBatch
+    {
+    public:
+        explicit SpriteBatch(const sf::Texture* p_texture = nullptr);
+
+        void SetTexture(const sf::Texture* p_texture);
+        inline const sf::Texture* GetTexture() const { return mp_texture; }
+
+        void Clear();
+        void Reserve(size_t count);
+        void Add(const sf::Vector2f& position, const sf::IntRect& texrect, const sf::Color& color = sf::Color::White);
+        void Add(const sf::Transform& transform, const sf::IntRect& texrect, const sf::Color& color = sf::Color::White);
+        void Add(const sf::Sprite& sprite);
+        /// Number of sprites added since the last Clear().
+        inline size_t GetSpriteCount() const { return m_vertices.size() / 4; }
+
+        void Record(DrawList& list, const sf::RenderStates& states = sf::RenderStates::Default) const;
+    private:
+        sf::Vertex* AppendQuad(const sf::IntRect& texrect, const sf::Color& color);
+
+        const sf::Texture* mp_texture; // Owned by the TextureCache, usually
+        std::vector<sf::Vertex> m_vertices; // Four per sprite
+#ifdef TSC_HAVE_VERTEX_BUFFER
+        mutable std::shared_ptr<sf::VertexBuffer> mp_buffer;
+#endif
+    };
+
+}
+
+#endif /* TSC_SPRITE_BATCH_HPP */
@@ -19,21 +19,156 @@
  ******************************************************************************/
 
 #include "texture_cache.hpp"
+#include "jobs.hpp"
 #include "pathmap.hpp"
+#include "util.hpp"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <string>
-#include <SFML/Graphics.hpp>
 
 using namespace TSC;
 using namespace Pathie;
+using namespace std;
+
+namespace {
+    // One slot in the texture cache.
+    struct CacheEntry
+    {
+        CacheEntry()
+            : ready(false), pending(false) {}
+
+        sf::Texture texture;
+        bool ready;   // Real image has been uploaded into `texture'
+        bool pending; // Queued for or undergoing background decoding
+    };
+
+    // A PNG file waiting to be decoded by a worker thread.
+    struct DecodeJob
+    {
+        string relpath;
+        string abspath;
+    };
+
+    // A PNG file decoded by a worker thread, waiting for upload.
+    struct DecodeResult
+    {
+        string relpath;
+        sf::Image image;
+        bool success;
+    };
+}
 
 // Actual global texture cache.
-static std::map<std::string, sf::Texture> s_cache;
+static map<string, CacheEntry> s_cache;
+
+/* Shared state between the main thread and the decoding jobs.
+ * s_jobs and s_results are protected by s_mutex; the main thread
+ * waits on s_result_cond if it needs a specific texture synchronously.
+ * s_decodes counts the decoding jobs submitted to the job system. */
+static mutex s_mutex;
+static condition_variable s_result_cond;
+static deque<DecodeJob> s_jobs;
+static deque<DecodeResult> s_results;
+static Jobs::Counter s_decodes;
+
+/* Job that decodes the oldest queued PNG file. One such job is
+ * submitted per queued file, but the file may already have been
+ * taken by finish_pending(), in which case there is nothing to do. */
+static void decode_next()
+{
+    DecodeJob job;
+    {
+        lock_guard<mutex> lock(s_mutex);
+        if (s_jobs.empty())
+            return;
+
+        job = move(s_jobs.front());
+        s_jobs.pop_front();
+    }
+
+    // The expensive part, done without holding the lock.
+    DecodeResult result;
+    result.relpath = move(job.relpath);
+    result.success = result.image.loadFromFile(job.abspath);
+
+    {
+        lock_guard<mutex> lock(s_mutex);
+        s_results.push_back(move(result));
+    }
+    s_result_cond.notify_all();
+}
+
+/* Upload the decoded image into the cache slot. The sf::Texture
+ * object is reused so that references handed out by Request()
+ * remain valid. */
+static void upload(CacheEntry& entry, const DecodeResult& result)
+{
+    entry.pending = false;
+    entry.ready   = true;
+
+    if (!result.success)
+        return; // SFML already printed an error, keep the placeholder
+
+    unsigned int maxedge = sf::Texture::getMaximumSize();
+    if (result.image.getSize().x > maxedge || result.image.getSize().y > maxedge) {
+        warn(format("Texture '%s' is too large for your graphics card, which only supports up to %d pixels for an edge!", result.relpath.c_str(), maxedge));
+        return;
+    }
+
+    entry.texture.loadFromImage(result.image);
+}
+
+/* Block until the background decoding of `relpath' is done and
+ * upload it. If the job has not yet been picked up by a worker,
+ * it is decoded right here instead of waiting for the queue. */
+static void finish_pending(const string& relpath, CacheEntry& entry)
+{
+    DecodeResult result;
+    bool found = false;
+
+    {
+        unique_lock<mutex> lock(s_mutex);
+
+        auto jobiter = find_if(s_jobs.begin(), s_jobs.end(),
+                               [&](const DecodeJob& job){ return job.relpath == relpath; });
+        if (jobiter != s_jobs.end()) {
+            DecodeJob job = move(*jobiter);
+            s_jobs.erase(jobiter);
+            lock.unlock();
+
+            result.relpath = relpath;
+            result.success = result.image.loadFromFile(job.abspath);
+            found = true;
+        }
+        else {
+            while (!found) {
+                auto resiter = find_if(s_results.begin(), s_results.end(),
+                                       [&](const DecodeResult& res){ return res.relpath == relpath; });
+                if (resiter != s_results.end()) {
+                    result = move(*resiter);
+                    s_results.erase(resiter);
+                    found = true;
+                }
+                else {
+                    s_result_cond.wait(lock);
+                }
+            }
+        }
+    }
+
+    upload(entry, result);
+}
 
 /**
  * Retrieve a texture from the list of loaded textures. If the texture
  * has not yet been loaded, does so and places it in the list of loaded
- * textures.
+ * textures. This function blocks until the texture is available; if
+ * it was Request()ed before, it waits for the background decoding
+ * rather than decoding the file a second time.
  *
  * \param relpath
  * Path to the file to load as a texture. This needs to be relative
@@ -41,11 +176,144 @@ static std::map<std::string, sf::Texture> s_cache;
  */
 sf::Texture& TextureCache::Get(const std::string& relpath)
 {
-    if (s_cache.count(relpath) > 0)
-        return s_cache[relpath];
-    else {
+    CacheEntry& entry = s_cache[relpath];
+
+    if (!entry.ready) {
+        if (entry.pending) {
+            finish_pending(relpath, entry);
+        }
+        else {
+            Path p = Pathmap::GetPixmapsPath() / relpath;
+            entry.texture.loadFromFile(p.utf8_str());
+            entry.ready = true;
+        }
+    }
+
+    return entry.texture;
+}
+
+/**
+ * Like Get(), but does not block. If the texture has not yet been
+ * loaded, it is queued for decoding on a background thread and the
+ * returned texture is an empty placeholder until the main loop has
+ * uploaded the decoded image (see IsReady()). The reference returned
+ * stays valid and will refer to the real texture afterwards.
+ *
+ * Note that an sf::Sprite remembers the texture size when its texture
+ * is set; call setTexture() with `resetRect` set to true once the
+ * texture became ready.
+ */
+sf::Texture& TextureCache::Request(const std::string& relpath)
+{
+    CacheEntry& entry = s_cache[relpath];
+
+    if (!entry.ready && !entry.pending) {
         Path p = Pathmap::GetPixmapsPath() / relpath;
-        s_cache[relpath].loadFromFile(p.utf8_str());
-        return s_cache[relpath];
+
+        {
+            lock_guard<mutex> lock(s_mutex);
+            s_jobs.push_back(DecodeJob{relpath, p.utf8_str()});
+        }
+        Jobs::Submit("TextureCache::decode", decode_next, &s_decodes);
+
+        entry.pending = true;
+    }
+
+    return entry.texture;
+}
+
+/**
+ * Returns true if the given texture has been fully loaded, i.e. the
+ * texture returned by Request() is not a placeholder anymore.
+ */
+bool TextureCache::IsReady(const std::string& relpath)
+{
+    auto iter = s_cache.find(relpath);
+    return iter != s_cache.end() && iter->second.ready;
+}
+
+/**
+ * Queue all the given textures for background decoding. Scenes should
+ * call this with the list of textures they (or the scenes they are
+ * about to push) are going to need, so that the later Get() or
+ * Request() calls find them already decoded.
+ */
+void TextureCache::Preload(const vector<string>& relpaths)
+{
+    for (const string& relpath: relpaths)
+        Request(relpath);
+}
+
+/**
+ * Loads a texture that is already in the cache from disk again, into
+ * the very same sf::Texture object. Textures that have never been
+ * requested are ignored, so this can be called for any file that has
+ * changed. If the new file cannot be loaded (e.g. because it is still
+ * being written), the old image is kept. This function blocks.
+ *
+ * \returns false if the texture was not in the cache.
+ */
+bool TextureCache::Reload(const std::string& relpath)
+{
+    auto iter = s_cache.find(relpath);
+    if (iter == s_cache.end())
+        return false;
+
+    CacheEntry& entry = iter->second;
+    if (entry.pending)
+        finish_pending(relpath, entry);
+
+    Path p = Pathmap::GetPixmapsPath() / relpath;
+
+    DecodeResult result;
+    result.relpath = relpath;
+    result.success = result.image.loadFromFile(p.utf8_str());
+    upload(entry, result);
+
+    return true;
+}
+
+/**
+ * Upload textures decoded in the background to the graphics card.
+ * Call this once a frame from the main thread. Uploading stops once
+ * `budget' is exceeded; the remaining textures are uploaded in the
+ * next frames. At least one texture is uploaded per call so that
+ * progress is guaranteed even with a tiny budget.
+ */
+void TextureCache::Update(sf::Time budget)
+{
+    sf::Clock clock;
+
+    while (true) {
+        DecodeResult result;
+        {
+            lock_guard<mutex> lock(s_mutex);
+            if (s_results.empty())
+                return;
+
+            result = move(s_results.front());
+            s_results.pop_front();
+        }
+
+        upload(s_cache[result.relpath], result);
+
+        if (clock.getElapsedTime() >= budget)
+            return;
+    }
+}
+
+/**
+ * Discard all textures not yet decoded and wait for the decoding jobs
+ * to finish. Call this at the end of the programme, before the job
+ * system is shut down.
+ */
+void TextureCache::Cleanup()
+{
+    {
+        lock_guard<mutex> lock(s_mutex);
+        s_jobs.clear();
     }
+
+    Jobs::Wait(s_decodes);
+    s_results.clear();
 }
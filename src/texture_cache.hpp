@@ -21,6 +21,8 @@
 #ifndef TSC_TEXTURE_CACHE_HPP
 #define TSC_TEXTURE_CACHE_HPP
 #include <string>
+#include <vector>
+#include <SFML/System/Time.hpp>
 
 // forward-declare
 namespace sf {
@@ -32,9 +34,34 @@ namespace TSC {
     /**
      * The global cache for all textures uploaded to the graphics
      * card.
+     *
+     * Textures can be retrieved in two ways. Get() loads the texture
+     * synchronously, i.e. it blocks until the PNG file is decoded and
+     * uploaded. Request() instead queues the file for decoding on a
+     * background thread and immediately returns a placeholder texture;
+     * once the decoded image has been uploaded by Update(), the very
+     * same sf::Texture object contains the real image and IsReady()
+     * returns true. Scenes can use Preload() to have textures decoded
+     * before they are needed at all.
+     *
+     * Decoding happens off the main thread, but the upload to the
+     * graphics card always happens in Update(), which the main loop
+     * calls once a frame with a time budget so that uploading many
+     * textures does not cause a frame hitch.
+     *
+     * Reload() reads a texture from disk again, e.g. when the file has
+     * been changed while the game is running (see FileWatcher). Again
+     * the sf::Texture object stays the same, so everything using it
+     * shows the new image without having to be set up again.
      */
     namespace TextureCache {
         sf::Texture& Get(const std::string& relpath);
+        sf::Texture& Request(const std::string& relpath);
+        bool IsReady(const std::string& relpath);
+        void Preload(const std::vector<std::string>& relpaths);
+        bool Reload(const std::string& relpath);
+        void Update(sf::Time budget);
+        void Cleanup();
     };
 }
 
@@ -24,6 +24,7 @@
 #include <cstdarg>
 #include <cstdlib>
 #include <cmath>
+#include <fstream>
 #include <pathie/path.hpp>
 #include <SFML/System.hpp>
 
@@ -130,3 +131,30 @@ bool TSC::float_equal(float a, float b, float epsilon)
 {
     return fabs(a - b) < epsilon;
 }
+
+/**
+ * Calculates the 64-bit FNV-1a hash of the given file's contents.
+ * This is not a cryptographic hash; it is meant to detect outdated
+ * generated files, e.g. the binary tileset metadata generated by
+ * tscproc, whose implementation this has to match.
+ *
+ * \returns false if the file cannot be read, true otherwise.
+ */
+bool TSC::hash_file(const Pathie::Path& path, uint64_t& hash)
+{
+    ifstream file(path.utf8_str(), ios::in | ios::binary);
+    if (!file)
+        return false;
+
+    char buf[4096];
+    hash = 14695981039346656037ULL; // FNV offset basis
+    while (file.read(buf, sizeof(buf)) || file.gcount() > 0) {
+        streamsize len = file.gcount();
+        for (streamsize i=0; i < len; i++) {
+            hash ^= static_cast<unsigned char>(buf[i]);
+            hash *= 1099511628211ULL; // FNV prime
+        }
+    }
+
+    return !file.bad();
+}
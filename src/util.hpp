@@ -21,6 +21,7 @@
 #ifndef TSC_UTIL_HPP
 #define TSC_UTIL_HPP
 #include <string>
+#include <cstdint>
 #include <SFML/System/String.hpp>
 
 // forward-declare
@@ -35,6 +36,7 @@ namespace TSC {
     sf::String utf82sf(const std::string& utf8);
     sf::String path2sf(const Pathie::Path& path);
     bool float_equal(float a, float b, float epsilon = 0.0001f);
+    bool hash_file(const Pathie::Path& path, uint64_t& hash);
 }
 
 #endif /* TSC_UTIL_HPP */
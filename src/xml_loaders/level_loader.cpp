@@ -2,14 +2,58 @@
 #include "../level.hpp"
 #include "../xerces_helpers.hpp"
 #include <xercesc/sax2/Attributes.hpp>
+#include <xercesc/util/XMLString.hpp>
+#include <algorithm>
+#include <memory>
 
 using namespace std;
 using namespace xercesc;
 using namespace TSC;
 
-LevelLoader::LevelLoader(Level& level)
+namespace {
+    /* Names of the elements and attributes in the level file, converted
+     * to Xerces strings once. Comparing them with XMLString::equals()
+     * avoids converting each name Xerces reports (there is one element
+     * and three attributes per field) to UTF-8. */
+    struct Names
+    {
+        unique_ptr<XMLCh[]> level         = utf8_to_xstr("level");
+        unique_ptr<XMLCh[]> enginever     = utf8_to_xstr("enginever");
+        unique_ptr<XMLCh[]> width         = utf8_to_xstr("width");
+        unique_ptr<XMLCh[]> height        = utf8_to_xstr("height");
+        unique_ptr<XMLCh[]> fixedcamspeed = utf8_to_xstr("fixedcamspeed");
+        unique_ptr<XMLCh[]> music         = utf8_to_xstr("music");
+        unique_ptr<XMLCh[]> player        = utf8_to_xstr("player");
+        unique_ptr<XMLCh[]> ground        = utf8_to_xstr("ground");
+        unique_ptr<XMLCh[]> tileset       = utf8_to_xstr("tileset");
+        unique_ptr<XMLCh[]> x             = utf8_to_xstr("x");
+        unique_ptr<XMLCh[]> y             = utf8_to_xstr("y");
+        unique_ptr<XMLCh[]> field         = utf8_to_xstr("field");
+        unique_ptr<XMLCh[]> relx          = utf8_to_xstr("relx");
+        unique_ptr<XMLCh[]> rely          = utf8_to_xstr("rely");
+        unique_ptr<XMLCh[]> tid           = utf8_to_xstr("tid");
+    };
+
+    // Created on first use, as Xerces needs to be initialised first.
+    const Names& names()
+    {
+        static const Names s_names;
+        return s_names;
+    }
+
+    /* Parses the integer attribute `name`. Throws a Xerces
+     * NumberFormatException if it is missing or not a number. */
+    int int_attribute(const Attributes& attributes, const unique_ptr<XMLCh[]>& name)
+    {
+        return XMLString::parseInt(attributes.getValue(name.get()));
+    }
+}
+
+LevelLoader::LevelLoader(Level& level, Arena& arena)
     : DefaultHandler(),
-      m_level(level)
+      m_level(level),
+      m_current_fields(ArenaAllocator<Field>(arena)),
+      m_fields_hint(0)
 {
 }
 
@@ -18,35 +62,40 @@ void LevelLoader::startElement(const XMLCh* const,
                                const XMLCh* const,
                                const Attributes& attributes)
 {
-    m_chars.clear();
-    string localname = X2U(xlocalname);
+    const Names& n = names();
 
-    if (localname == "level") {
-        int enginever = stoi(X2U(attributes.getValue(U2X("enginever"))));
+    if (XMLString::equals(xlocalname, n.field.get())) {
+        int relx = int_attribute(attributes, n.relx);
+        int rely = int_attribute(attributes, n.rely);
+        int tid  = int_attribute(attributes, n.tid);
+        m_current_fields.emplace_back(relx, rely, tid);
+    }
+    else if (XMLString::equals(xlocalname, n.level.get())) {
+        int enginever = int_attribute(attributes, n.enginever);
         if (enginever != LEVEL_ENGINE_VERSION)
             throw(runtime_error("Unsupported level engine version"));
 
-        m_level.m_width           = stoi(X2U(attributes.getValue(U2X("width"))));
-        m_level.m_height          = stoi(X2U(attributes.getValue(U2X("height"))));
-        m_level.m_fixed_cam_speed = stoi(X2U(attributes.getValue(U2X("fixedcamspeed"))));
-        m_level.m_music           = X2U(attributes.getValue(U2X("music")));
+        m_level.m_width           = int_attribute(attributes, n.width);
+        m_level.m_height          = int_attribute(attributes, n.height);
+        m_level.m_fixed_cam_speed = int_attribute(attributes, n.fixedcamspeed);
+        m_level.m_music           = X2U(attributes.getValue(n.music.get()));
     }
-    else if (localname == "player") {
+    else if (XMLString::equals(xlocalname, n.player.get())) {
         // TODO
     }
-    else if (localname == "ground") {
-        m_current_tileset = X2U(attributes.getValue(U2X("tileset")));
-        int x = stoi(X2U(attributes.getValue(U2X("x"))));
-        int y = stoi(X2U(attributes.getValue(U2X("y"))));
+    else if (XMLString::equals(xlocalname, n.ground.get())) {
+        m_current_tileset = X2U(attributes.getValue(n.tileset.get()));
+        int x = int_attribute(attributes, n.x);
+        int y = int_attribute(attributes, n.y);
 
         m_level.m_grounds.resize(m_level.m_grounds.size() + 1);
         m_level.m_grounds[m_level.m_grounds.size()-1].setPosition(x, y);
-    }
-    else if (localname == "field") {
-        int relx = stoi(X2U(attributes.getValue(U2X("relx"))));
-        int rely = stoi(X2U(attributes.getValue(U2X("rely"))));
-        int tid  = stoi(X2U(attributes.getValue(U2X("tid"))));
-        m_current_fields.emplace_back(relx, rely, tid);
+
+        /* Grounds of a level tend to be of similar size, so assume
+         * that this one is as large as the largest one before to
+         * avoid growing the field list over and over, which would
+         * leave the old lists unused in the arena. */
+        m_current_fields.reserve(m_fields_hint);
     }
 }
 
@@ -54,16 +103,14 @@ void LevelLoader::endElement(const XMLCh* const,
                              const XMLCh* const xlocalname,
                              const XMLCh* const)
 {
-    string localname = X2U(xlocalname);
+    if (XMLString::equals(xlocalname, names().ground.get())) {
+        m_fields_hint = max(m_fields_hint, m_current_fields.size());
 
-    if (localname == "ground") {
-        m_level.m_grounds[m_level.m_grounds.size()-1].reset(m_current_tileset, m_current_fields);
+        /* The grounds are set up all at once after parsing, see
+         * Level::LoadGrounds(). Moving leaves m_current_fields empty. */
+        ground_tilesets.push_back(m_current_tileset);
+        ground_fields.push_back(std::move(m_current_fields));
         m_current_tileset.clear();
         m_current_fields.clear();
     }
 }
-
-void LevelLoader::characters(const XMLCh* const chars, const XMLSize_t)
-{
-    m_chars.append(X2U(chars));
-}
@@ -1,18 +1,27 @@
 #ifndef TSC_LEVEL_LOADER_HPP
 #define TSC_LEVEL_LOADER_HPP
 #include <xercesc/sax2/DefaultHandler.hpp>
+#include "../arena.hpp"
 #include "../ground.hpp"
 
 namespace TSC {
 
     class Level;
 
+    /**
+     * SAX handler reading a level file into a Level. The fields of
+     * the grounds are only collected; the Level sets up its grounds
+     * from them afterwards (see Level::LoadGrounds()). They are
+     * allocated from `arena`, which must outlive the loader.
+     */
     class LevelLoader: public xercesc::DefaultHandler
     {
     public:
+        typedef std::vector<Field, ArenaAllocator<Field>> FieldList;
+
         const int LEVEL_ENGINE_VERSION = 300;
 
-        LevelLoader(Level& level);
+        LevelLoader(Level& level, Arena& arena);
         virtual void startElement(const XMLCh* const,
                                   const XMLCh* const,
                                   const XMLCh* const,
@@ -22,13 +31,14 @@ namespace TSC {
                                 const XMLCh* const xlocalname,
                                 const XMLCh* const);
 
-        virtual void characters(const XMLCh* const chars, const XMLSize_t);
-
+        // Tileset and fields of each ground, for Level::LoadGrounds()
+        std::vector<std::string> ground_tilesets;
+        std::vector<FieldList> ground_fields;
     private:
         Level& m_level;
-        std::string m_chars;
         std::string m_current_tileset;
-        std::vector<Field> m_current_fields;
+        FieldList m_current_fields;
+        size_t m_fields_hint; // Largest number of fields of a ground so far
     };
 
 }
@@ -0,0 +1,249 @@
+/* TSC is a two-dimensional jump’n’run platform game.
+ * Copyright © 2017 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "batch.hpp"
+#include "genbin.hpp"
+#include "genmeta.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+
+    // One tileset found in the directory, i.e. a NAME.png with a NAME.xml.
+    struct tileset_job {
+        string name;
+        bool has_colrects;
+
+        // Results, filled in by the worker thread
+        bool failed;
+        string message;
+        map<string, uint64_t> cache_entries;
+    };
+
+}
+
+static mutex s_output_mutex;
+
+// Combine two hashes into one cache key.
+static uint64_t combine_hashes(uint64_t a, uint64_t b)
+{
+    return a ^ (b + 0x9E3779B97F4A7C15ULL + (a << 6) + (a >> 2));
+}
+
+static bool ends_with(const string& str, const string& suffix)
+{
+    return str.size() >= suffix.size() &&
+        str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/* The cache file consists of lines of the form "KEY FILENAME", where
+ * KEY is a hexadecimal hash over the inputs FILENAME was generated
+ * from. A missing or broken cache file just means that everything
+ * is regenerated. */
+static map<string, uint64_t> read_cache(const string& path)
+{
+    map<string, uint64_t> cache;
+    ifstream file(path);
+    string line;
+
+    while (getline(file, line)) {
+        istringstream stream(line);
+        uint64_t key = 0;
+        string filename;
+
+        if (stream >> hex >> key >> filename)
+            cache[filename] = key;
+    }
+
+    return cache;
+}
+
+static void write_cache(const string& path, const map<string, uint64_t>& cache)
+{
+    ofstream file(path);
+    for(const auto& entry: cache)
+        file << hex << entry.second << " " << entry.first << "\n";
+
+    if (!file)
+        cerr << "Warning: Failed to write cache file '" << path << "'." << endl;
+}
+
+static uint64_t hash_or_throw(const string& path)
+{
+    uint64_t hash = 0;
+    if (!hash_file(path, hash))
+        throw(runtime_error("Failed to read '" + path + "'."));
+
+    return hash;
+}
+
+/* Regenerates the outdated files of one tileset. NAME.xml is
+ * regenerated from NAME.colrects.png if that exists, keeping the
+ * rows and columns of the existing NAME.xml; NAME.tsb is
+ * regenerated from NAME.xml and NAME.png. */
+static void process_tileset(const string& dir, const map<string, uint64_t>& cache, tileset_job& job)
+{
+    string base     = dir + "/" + job.name;
+    string pngfile  = base + ".png";
+    string xmlfile  = base + ".xml";
+    string collfile = base + ".colrects.png";
+    string binfile  = base + ".tsb";
+    vector<string> done;
+
+    uint64_t xml_hash = hash_or_throw(xmlfile);
+
+    if (job.has_colrects) {
+        uint64_t key = combine_hashes(hash_or_throw(collfile), xml_hash);
+        auto iter    = cache.find(job.name + ".xml");
+
+        if (iter == cache.end() || iter->second != key) {
+            tileset_info info = parse_tileset_info(xmlfile);
+            write_meta_xml(collfile, info.rows, info.cols, xmlfile);
+
+            xml_hash = hash_or_throw(xmlfile);
+            key = combine_hashes(hash_or_throw(collfile), xml_hash);
+            done.push_back(job.name + ".xml");
+        }
+
+        job.cache_entries[job.name + ".xml"] = key;
+    }
+
+    uint64_t key = combine_hashes(hash_or_throw(pngfile), xml_hash);
+    auto iter    = cache.find(job.name + ".tsb");
+
+    if (iter == cache.end() || iter->second != key || !file_exists(binfile)) {
+        write_meta_bin(xmlfile, pngfile, binfile);
+        done.push_back(job.name + ".tsb");
+    }
+
+    job.cache_entries[job.name + ".tsb"] = key;
+
+    if (done.empty()) {
+        job.message = job.name + ": up to date";
+    }
+    else {
+        job.message = job.name + ": generated";
+        for(const string& filename: done)
+            job.message += " " + filename;
+    }
+}
+
+static void worker(const string& dir, const map<string, uint64_t>& cache, vector<tileset_job>& jobs, atomic<size_t>& next)
+{
+    size_t index = 0;
+    while ((index = next++) < jobs.size()) {
+        tileset_job& job = jobs[index];
+
+        try {
+            process_tileset(dir, cache, job);
+        }
+        catch (const runtime_error& err) {
+            job.failed  = true;
+            job.message = job.name + ": Error: " + err.what();
+        }
+
+        lock_guard<mutex> lock(s_output_mutex);
+        (job.failed ? cerr : cout) << job.message << endl;
+    }
+}
+
+/**
+ * Processes all tilesets in the directory `dir' in parallel with
+ * the given number of threads (0 means one per CPU core). A tileset
+ * is a NAME.png file that is accompanied by a NAME.xml metadata file.
+ * If there is a NAME.colrects.png collision rectangle file, NAME.xml
+ * is regenerated from it first. Afterwards NAME.tsb is regenerated
+ * from NAME.xml and NAME.png.
+ *
+ * Files whose inputs did not change since the last run are skipped;
+ * to detect this, hashes of the inputs are kept in the BATCH_CACHE_FILE
+ * in `dir'. Delete it to force regeneration of everything.
+ *
+ * \returns the programme's exit code: 0 on success, 1 if any of the
+ * tilesets failed.
+ */
+int process_tileset_directory(const string& dir, int jobcount)
+{
+    vector<string> filenames;
+    if (!list_directory(dir, filenames)) {
+        cerr << "Error: Failed to read directory '" << dir << "'." << endl;
+        return 1;
+    }
+    sort(filenames.begin(), filenames.end());
+
+    vector<tileset_job> jobs;
+    for(const string& filename: filenames) {
+        if (!ends_with(filename, ".png") || ends_with(filename, ".colrects.png"))
+            continue;
+
+        string name = filename.substr(0, filename.size() - 4);
+        if (!binary_search(filenames.begin(), filenames.end(), name + ".xml"))
+            continue;
+
+        tileset_job job;
+        job.name         = name;
+        job.has_colrects = binary_search(filenames.begin(), filenames.end(), name + ".colrects.png");
+        job.failed       = false;
+        jobs.push_back(move(job));
+    }
+
+    if (jobs.empty()) {
+        cerr << "Warning: No tilesets found in '" << dir << "'." << endl;
+        return 0;
+    }
+
+    if (jobcount <= 0)
+        jobcount = max(thread::hardware_concurrency(), 1u);
+    jobcount = static_cast<int>(min(static_cast<size_t>(jobcount), jobs.size()));
+
+    string cachefile = dir + "/" + BATCH_CACHE_FILE;
+    map<string, uint64_t> cache = read_cache(cachefile);
+    atomic<size_t> next(0);
+
+    vector<thread> threads;
+    for(int i=1; i < jobcount; i++)
+        threads.emplace_back(worker, cref(dir), cref(cache), ref(jobs), ref(next));
+    worker(dir, cache, jobs, next); // Main thread participates
+    for(thread& t: threads)
+        t.join();
+
+    // Failed tilesets are left out so that they are retried next time.
+    map<string, uint64_t> newcache;
+    int result = 0;
+    for(const tileset_job& job: jobs) {
+        if (job.failed)
+            result = 1;
+        else
+            newcache.insert(job.cache_entries.begin(), job.cache_entries.end());
+    }
+
+    write_cache(cachefile, newcache);
+    return result;
+}
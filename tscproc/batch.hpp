@@ -0,0 +1,28 @@
+/* TSC is a two-dimensional jump’n’run platform game.
+ * Copyright © 2017 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TSCPROC_BATCH_HPP
+#define TSCPROC_BATCH_HPP
+#include <string>
+
+/* Name of the file in a tileset directory that remembers the inputs
+ * of the files generated by the last batch run. */
+#define BATCH_CACHE_FILE ".tscproc-cache"
+
+int process_tileset_directory(const std::string& dir, int jobs);
+
+#endif /* TSCPROC_BATCH_HPP */
@@ -18,6 +18,8 @@
 #include "commandline.hpp"
 #include <string>
 #include <iostream>
+#include <climits>
+#include <cstdlib>
 
 using namespace std;
 
@@ -39,17 +41,28 @@ static void print_help()
 "\n"
 "MODES:\n"
 "\n"
+"  -B           Output a binary metadata file from a metadata XML\n"
+"               file and its tileset.\n"
+"  -D DIR       Process all tilesets in DIR in parallel: regenerate\n"
+"               NAME.xml from NAME.colrects.png if present, then\n"
+"               NAME.tsb from NAME.xml and NAME.png. Unchanged\n"
+"               files are skipped.\n"
 "  -M           Output a metadata XML file.\n"
 "  -P           Output a bbox PNG file.\n"
 "\n"
 "OPTIONS:\n"
 "\n"
+"  -b FILE       Binary metadata file. Pass - for standard output.\n"
+"                (only -B)\n"
 "  -c FILE       Collision box PNG file.\n"
 "  -d ROWS:COLS  If the input is a PNG file, this option gives\n"
 "                the number of rows and columns the tileset has,\n"
 "                in numbers of tiles. (only -M)\n"
 "  -h            Print this help.\n"
-"  -t FILE       Tileset PNG file. Pass - for standard input. (only -P)\n"
+"  -j N          Number of threads to use. Defaults to the number\n"
+"                of CPU cores. (only -D)\n"
+"  -t FILE       Tileset PNG file. Pass - for standard input. (only -P\n"
+"                and -B; -B does not accept standard input)\n"
 "  -x FILE       Metadata XML file. Pass - for standard output.\n";
     exit(3);
 }
@@ -65,6 +78,7 @@ void parse_commandline(int argc, char* argv[])
 {
     cmdline.htiles = 0;
     cmdline.vtiles = 0;
+    cmdline.jobs   = 0;
     cmdline.mode   = cmdmode::none;
 
     for(int i=1; i < argc; i++) {
@@ -101,6 +115,16 @@ void parse_commandline(int argc, char* argv[])
                 if (cmdline.xmlfile == "-")
                     cmdline.xmlfile.clear();
 
+                break;
+            case 'b':
+                if (i + 1 >= argc)
+                    print_help();
+
+                cmdline.binfile = argv[++i];
+
+                if (cmdline.binfile == "-")
+                    cmdline.binfile.clear();
+
                 break;
             case 'c':
                 if (i + 1 >= argc)
@@ -111,6 +135,26 @@ void parse_commandline(int argc, char* argv[])
                 if (cmdline.collfile == "-")
                     cmdline.collfile.clear();
 
+                break;
+            case 'j': {
+                if (i + 1 >= argc)
+                    print_help();
+
+                // stoi() would throw for anything but a number
+                char* p_end = NULL;
+                long jobs = strtol(argv[++i], &p_end, 10);
+                if (p_end == argv[i] || *p_end != '\0' || jobs < 0 || jobs > INT_MAX)
+                    print_help();
+
+                cmdline.jobs = static_cast<int>(jobs);
+                break;
+            }
+            case 'D':
+                if (i + 1 >= argc)
+                    print_help();
+
+                cmdline.mode     = cmdmode::batch;
+                cmdline.batchdir = argv[++i];
                 break;
             case 'P':
                 cmdline.mode = cmdmode::png;
@@ -118,6 +162,9 @@ void parse_commandline(int argc, char* argv[])
             case 'M':
                 cmdline.mode = cmdmode::metadata;
                 break;
+            case 'B':
+                cmdline.mode = cmdmode::binary;
+                break;
             case 'h':
                 print_help();
                 break;
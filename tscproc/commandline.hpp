@@ -22,7 +22,9 @@
 enum class cmdmode {
     none = 0,
     png,
-    metadata
+    metadata,
+    binary,
+    batch
 };
 
 struct cmdargs {
@@ -31,6 +33,9 @@ struct cmdargs {
     std::string tilesetfile;
     std::string collfile;
     std::string xmlfile;
+    std::string binfile;
+    std::string batchdir;
+    int jobs;
     cmdmode mode;
 };
 extern cmdargs cmdline;
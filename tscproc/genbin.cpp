@@ -0,0 +1,114 @@
+/* TSC is a two-dimensional jump’n’run platform game.
+ * Copyright © 2017 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "genbin.hpp"
+#include "commandline.hpp"
+#include "parser.hpp"
+#include "util.hpp"
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+// Append `val' to `buf' as `bytes' little-endian bytes.
+static void put_le(vector<char>& buf, uint64_t val, int bytes)
+{
+    for (int i=0; i < bytes; i++)
+        buf.push_back(static_cast<char>((val >> (8 * i)) & 0xFF));
+}
+
+static vector<char> build_bin(const tileset_info& info, uint64_t png_hash, uint64_t xml_hash)
+{
+    size_t count = 0;
+    for(const vector<bbox>& tile: info.tiles)
+        count += tile.size();
+
+    vector<char> buf;
+    buf.reserve(40 + 8 * info.tiles.size() + 16 * count);
+
+    buf.insert(buf.end(), TILESET_BIN_MAGIC, TILESET_BIN_MAGIC + 4);
+    put_le(buf, TILESET_BIN_VERSION, 4);
+    put_le(buf, png_hash, 8);
+    put_le(buf, xml_hash, 8);
+    put_le(buf, static_cast<uint32_t>(info.rows), 4);
+    put_le(buf, static_cast<uint32_t>(info.cols), 4);
+    put_le(buf, info.tiles.size(), 4);
+    put_le(buf, count, 4);
+
+    size_t first = 0;
+    for(const vector<bbox>& tile: info.tiles) {
+        put_le(buf, first, 4);
+        put_le(buf, tile.size(), 4);
+        first += tile.size();
+    }
+
+    for(const vector<bbox>& tile: info.tiles) {
+        for(const bbox& box: tile) {
+            put_le(buf, static_cast<uint32_t>(box.x), 4);
+            put_le(buf, static_cast<uint32_t>(box.y), 4);
+            put_le(buf, static_cast<uint32_t>(box.w), 4);
+            put_le(buf, static_cast<uint32_t>(box.h), 4);
+        }
+    }
+
+    return buf;
+}
+
+/**
+ * Generates the binary metadata file `binfile' (standard output
+ * if empty) from the metadata XML file `xmlfile' and the tileset
+ * PNG `tilesetfile'. This function does not depend on the global
+ * `cmdline' and can thus be used from multiple threads at once.
+ * Throws std::runtime_error on failure.
+ */
+void write_meta_bin(const string& xmlfile, const string& tilesetfile, const string& binfile)
+{
+    // The checksums require real files to read from.
+    if (xmlfile.empty() || tilesetfile.empty())
+        throw(runtime_error("Binary metadata requires both -x and -t to name files."));
+
+    uint64_t png_hash = 0;
+    uint64_t xml_hash = 0;
+    if (!hash_file(tilesetfile, png_hash))
+        throw(runtime_error("Failed to read tileset file '" + tilesetfile + "'."));
+    if (!hash_file(xmlfile, xml_hash))
+        throw(runtime_error("Failed to read metadata file '" + xmlfile + "'."));
+
+    tileset_info info = parse_tileset_info(xmlfile);
+    if (info.rows <= 0 || info.cols <= 0)
+        throw(runtime_error("No rows and/or columns found in the tileset metadata '" + xmlfile + "'."));
+
+    vector<char> buf = build_bin(info, png_hash, xml_hash);
+
+    // Output goes to real file if passed, otherwise standard output.
+    ofstream outfilefile;
+    if (!binfile.empty())
+        outfilefile.open(binfile, ios::out | ios::binary);
+    ostream& outfile = binfile.empty() ? cout : outfilefile;
+
+    outfile.write(buf.data(), buf.size());
+    if (!outfile)
+        throw(runtime_error("Failed to write binary metadata."));
+}
+
+void generate_meta_bin()
+{
+    write_meta_bin(cmdline.xmlfile, cmdline.tilesetfile, cmdline.binfile);
+}
@@ -0,0 +1,47 @@
+/* TSC is a two-dimensional jump’n’run platform game.
+ * Copyright © 2017 The TSC Contributors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TSCPROC_GENBIN_HPP
+#define TSCPROC_GENBIN_HPP
+#include <string>
+
+/* The binary tileset metadata format. TSC loads this instead of the
+ * XML metadata file if it exists and its checksums match, because
+ * it can be read with a single read() call instead of an XML parse.
+ * All integers are stored in little-endian byte order:
+ *
+ *   offset    size  content
+ *   0         4     magic bytes "TSCT"
+ *   4         4     format version (TILESET_BIN_VERSION)
+ *   8         8     FNV-1a hash of the tileset PNG file
+ *   16        8     FNV-1a hash of the tileset XML file
+ *   24        4     number of rows (signed)
+ *   28        4     number of columns (signed)
+ *   32        4     number of tiles (T)
+ *   36        4     number of collision rectangles (N)
+ *   40        8*T   per tile: index of its first collision rectangle
+ *                   and number of collision rectangles (unsigned)
+ *   40+8*T    16*N  collision rectangles as signed x, y, width, height
+ *
+ * TSC reads this in ground.cpp; keep both sides in sync. */
+#define TILESET_BIN_MAGIC "TSCT"
+#define TILESET_BIN_VERSION 2
+
+void generate_meta_bin();
+void write_meta_bin(const std::string& xmlfile, const std::string& tilesetfile, const std::string& binfile);
+
+#endif /* TSCPROC_GENBIN_HPP */
@@ -18,100 +18,148 @@
 #include "genmeta.hpp"
 #include "commandline.hpp"
 #include "util.hpp"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 #include <vector>
 #include <png.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TSCPROC_USE_SSE2
+#endif
+
 using namespace std;
 
-static vector<bbox> read_bboxes(int imgwidth, int imgheight, png_bytep row_pointers[])
+/* Returns the first X in [start, end) of the RGBA row `row' whose pixel
+ * is painted (see is_painted_pixel()), or `end' if there is none. */
+static int find_painted(const png_byte* row, int start, int end)
 {
-    int tilewidth  = imgwidth  / cmdline.htiles;
-    int tileheight = imgheight / cmdline.vtiles;
+    int x = start;
+#ifdef TSCPROC_USE_SSE2
+    /* Check four pixels at once: mask out everything but the alpha
+     * bytes and compare with zero. Each of the four pixels yields
+     * four bits in the movemask result. */
+    const __m128i alphamask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    const __m128i zero      = _mm_setzero_si128();
+    for(; x + 4 <= end; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x*4));
+        int transparent = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alphamask), zero));
+        if (transparent != 0xFFFF)
+            break; // The scalar loop below finds the exact pixel
+    }
+#endif
+    for(; x < end; x++)
+        if (is_painted_pixel(row + x*4))
+            return x;
 
-    vector<bbox> bboxes(cmdline.htiles * cmdline.vtiles);
+    return end;
+}
 
-    // Tile by tile, determine the bboxes.
-    for(int tileno=0; tileno < cmdline.htiles * cmdline.vtiles; tileno++) {
-        int vstart = tileno / cmdline.htiles * tileheight;
-        int vend   = vstart + tileheight; // excluded, this is one behind the last row
+// Counterpart to find_painted() looking for a transparent pixel.
+static int find_unpainted(const png_byte* row, int start, int end)
+{
+    int x = start;
+#ifdef TSCPROC_USE_SSE2
+    const __m128i alphamask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    const __m128i zero      = _mm_setzero_si128();
+    for(; x + 4 <= end; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x*4));
+        int transparent = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alphamask), zero));
+        if (transparent != 0)
+            break;
+    }
+#endif
+    for(; x < end; x++)
+        if (!is_painted_pixel(row + x*4))
+            return x;
 
-        // Get element to work with
-        struct bbox& box = bboxes[tileno];
-        box.x = box.y = box.w = box.h = -1;
+    return end;
+}
 
-        for(int y=vstart; y < vend; y++) {
-            png_bytep row = row_pointers[y];
+/* Decomposes the painted area of each tile in one row of tiles into
+ * rectangles. `band' points to the `tileheight' RGBA pixel rows of that
+ * tile row, `rowbytes' apart, and `bandno' is the index of the tile row.
+ *
+ * Each pixel row of a tile is split into its painted spans. A span that
+ * has exactly the same horizontal extent as a rectangle of the previous
+ * row extends that rectangle downwards; all other spans start a new
+ * rectangle. Thus a plain box yields one rectangle, an L-shape two and
+ * a staircase-like slope one per step, without any two rectangles
+ * overlapping. */
+static void read_band_bboxes(const png_byte* band, size_t rowbytes, int bandno, int tilewidth, int tileheight, int cols, vector<vector<bbox>>& tiles)
+{
+    vector<size_t> open;  // Indices of rectangles reaching the previous row
+    vector<size_t> still_open;
 
-            if (box.x >= 0 && box.w >= 0) {
-                /* 3. Determine the height of the box. The bottom-left corner
-                 * is used for that, and that one's reached either when the loop
-                 * enters white pixels again or the next row is beyond the tile's
-                 * edge. */
-                png_bytep p_pixel = &(row[box.x*4]);
+    for(int col=0; col < cols; col++) {
+        vector<bbox>& boxes = tiles[bandno * cols + col];
+        open.clear();
 
-                if (!is_painted_pixel(p_pixel) || y+1 >= vend) {
-                    box.h = y - box.y + 1;
-                    break; // Skip rest of tile iteration, tile is complete.
-                }
+        int hstart = col * tilewidth;      // included, this is the first column
+        int hend   = hstart + tilewidth;   // excluded, this is one behind the last column
 
-                continue; // Skip row iteration, not needed anymore
-            }
+        for(int y=0; y < tileheight; y++) {
+            const png_byte* row = band + y*rowbytes;
+            size_t nextopen = 0; // Both spans and `open' are ordered by x
+            still_open.clear();
+
+            int x = find_painted(row, hstart, hend);
+            while (x < hend) {
+                int xend = find_unpainted(row, x, hend);
+
+                // Skip rectangles of the previous row left of this span
+                while (nextopen < open.size() && boxes[open[nextopen]].x < x)
+                    nextopen++;
 
-            int hstart = tileno % cmdline.htiles * tilewidth; // included, this is the first column
-            int hend   = hstart + tilewidth; // excluded, this is one behind the last column
-            for(int x=hstart; x < hend; x++) {
-                png_bytep p_pixel = &(row[x*4]);
-
-                if (box.x < 0) {
-                    // 1. Determine the top-left corner of the bbox.
-                    if (is_painted_pixel(p_pixel)) {
-                        box.x = x;
-                        box.y = y;
-                    }
+                if (nextopen < open.size() && boxes[open[nextopen]].x == x && boxes[open[nextopen]].w == xend - x) {
+                    boxes[open[nextopen]].h++;
+                    still_open.push_back(open[nextopen]);
+                    nextopen++;
                 }
-                else if (box.w < 0) {
-                    /* 2. Determine the width of the bbox. The top-right corner
-                     * is used for that, and that one's reached either when the
-                     * loop enters white pixels again or the next column is beyond
-                     * the tile's edge. */
-                    if (!is_painted_pixel(p_pixel) || x+1 >= hend) {
-                        box.w = x - box.x + 1;
-                    }
+                else {
+                    boxes.push_back(bbox{x, bandno * tileheight + y, xend - x, 1});
+                    still_open.push_back(boxes.size() - 1);
                 }
+
+                x = find_painted(row, xend, hend);
             }
+
+            open.swap(still_open);
         }
     }
-
-    return bboxes;
 }
 
-static vector<bbox> extract_bboxes(FILE* infile)
+/* Reads the PNG row by row. Only one band of `tileheight' rows is kept
+ * in memory, which is processed as soon as it is complete. Interlaced
+ * images cannot be read this way, as each pass covers the whole image;
+ * for those, the whole image is read first. */
+static vector<vector<bbox>> extract_bboxes(FILE* infile, int rows, int cols)
 {
     png_structp p_png    = NULL;
     png_infop p_png_info = NULL;
-    vector<bbox> bboxes;
+
+    /* Image memory is owned by a vector so that it is released
+     * no matter which way this function is left. */
+    vector<png_byte> pixels;
+    vector<vector<bbox>> tiles(rows * cols);
 
     p_png = png_create_read_struct(PNG_LIBPNG_VER_STRING,
                                    NULL, NULL, NULL);
-    if (!p_png) {
-        cerr << "Internal error: cannot create PNG struct" << endl;
-        return bboxes;
-    }
+    if (!p_png)
+        throw(runtime_error("Internal error: cannot create PNG struct"));
 
     if (!(p_png_info = png_create_info_struct(p_png))) {
         png_destroy_read_struct(&p_png, NULL, NULL);
-        cerr << "Internal error: cannot create PNG info struct" << endl;
-        return bboxes;
+        throw(runtime_error("Internal error: cannot create PNG info struct"));
     }
 
     /* If libpng wants to signal an error, it will longjmp() here
      * (see libpng manual). */
     if (setjmp(png_jmpbuf(p_png))) {
         png_destroy_read_struct(&p_png, &p_png_info, NULL);
-        cerr << "Internal error while reading the PNG file" << endl;
-        return bboxes;
+        throw(runtime_error("Internal error while reading the PNG file"));
     }
 
     // Read PNG header
@@ -120,87 +168,146 @@ static vector<bbox> extract_bboxes(FILE* infile)
     png_read_info(p_png, p_png_info);
 
     // Get some info
-    int width  = png_get_image_width(p_png, p_png_info);
-    int height = png_get_image_height(p_png, p_png_info);
+    int width      = png_get_image_width(p_png, p_png_info);
+    int height     = png_get_image_height(p_png, p_png_info);
+    int tilewidth  = width  / cols;
+    int tileheight = height / rows;
 
-    png_set_interlace_handling(p_png);
-    png_read_update_info(p_png, p_png_info);
+    if (tilewidth <= 0 || tileheight <= 0) {
+        png_destroy_read_struct(&p_png, &p_png_info, NULL);
+        throw(runtime_error("Image is smaller than the number of rows and columns"));
+    }
 
-    // Read actual image into memory
-    png_bytep* row_pointers = (png_bytep*) malloc(sizeof(png_bytep) * height);
-    for (int y=0; y < height; y++)
-        row_pointers[y] = (png_byte*) malloc(png_get_rowbytes(p_png, p_png_info));
-    png_read_image(p_png, row_pointers);
+    /* Have libpng convert everything into 8-bit RGBA so that the
+     * scanning code only needs to deal with one pixel format. */
+    png_set_expand(p_png);
+    png_set_strip_16(p_png);
+    png_set_gray_to_rgb(p_png);
+    png_set_add_alpha(p_png, 0xFF, PNG_FILLER_AFTER);
+    int passes = png_set_interlace_handling(p_png);
+    png_read_update_info(p_png, p_png_info);
 
-    // Read bounding boxes
-    bboxes = move(read_bboxes(width, height, row_pointers));
+    size_t rowbytes = png_get_rowbytes(p_png, p_png_info);
 
-    // Cleanup
-    png_destroy_read_struct(&p_png, &p_png_info, NULL);
-    for(int y=0; y < height; y++)
-        free(row_pointers[y]);
-    free(row_pointers);
+    if (passes > 1) {
+        pixels.resize(rowbytes * height);
+        for(int pass=0; pass < passes; pass++)
+            for(int y=0; y < height; y++)
+                png_read_row(p_png, &pixels[y * rowbytes], NULL);
 
-    return bboxes;
-}
-
-static void output_xml(FILE* infile)
-{
-    if (cmdline.htiles <= 0 || cmdline.vtiles <= 0) {
-        cerr << "Error: Rows and/or columns specification required. Did you pass -d?" << endl;
-        return;
+        for(int bandno=0; bandno < rows; bandno++)
+            read_band_bboxes(&pixels[bandno * tileheight * rowbytes], rowbytes, bandno, tilewidth, tileheight, cols, tiles);
     }
+    else {
+        pixels.resize(rowbytes * tileheight);
+        for(int bandno=0; bandno < rows; bandno++) {
+            for(int y=0; y < tileheight; y++)
+                png_read_row(p_png, &pixels[y * rowbytes], NULL);
 
-    vector<bbox> bboxes = extract_bboxes(infile);
-
-    if (bboxes.empty())
-        cerr << "Warning: No collision rectangles found" << endl;
+            read_band_bboxes(pixels.data(), rowbytes, bandno, tilewidth, tileheight, cols, tiles);
+        }
+    }
 
-    // Output goes to real file if passed, otherwise standard output.
-    ofstream outfilefile;
-    if (!cmdline.xmlfile.empty())
-        outfilefile.open(cmdline.xmlfile);
-    ostream& outfile = cmdline.xmlfile.empty() ? cout : outfilefile;
+    png_destroy_read_struct(&p_png, &p_png_info, NULL);
+    return tiles;
+}
 
+static void output_xml(const vector<vector<bbox>>& tiles, int rows, int cols, ostream& outfile)
+{
     outfile << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl
             << "<tileset version=\"1.0\">" << endl
-            << "  <cols>" << cmdline.htiles << "</cols>" << endl
-            << "  <rows>" << cmdline.vtiles << "</rows>" << endl
+            << "  <cols>" << cols << "</cols>" << endl
+            << "  <rows>" << rows << "</rows>" << endl
             << "  <tiles>" << endl;
 
-    for(const bbox& box: bboxes) {
-        outfile << "    <tile>" << endl
-                << "      <colrect x=\""
-                  << box.x
-                  << "\" y=\""
-                  << box.y
-                  << "\" width=\""
-                  << box.w
-                  << "\" height=\""
-                  << box.h
-                  << "\"/>"
-                  << endl
-                << "    </tile>" << endl;
+    for(const vector<bbox>& boxes: tiles) {
+        outfile << "    <tile>" << endl;
+
+        for(const bbox& box: boxes) {
+            outfile << "      <colrect x=\""
+                      << box.x
+                      << "\" y=\""
+                      << box.y
+                      << "\" width=\""
+                      << box.w
+                      << "\" height=\""
+                      << box.h
+                      << "\"/>"
+                      << endl;
+        }
+
+        outfile << "    </tile>" << endl;
     }
 
     outfile << "  </tiles>" << endl
             << "</tileset>" << endl;
 }
 
-void generate_meta_xml()
+/**
+ * Reads the collision rectangles from the collision rectangle PNG
+ * `collfile' (standard input if empty), which depicts a tileset with
+ * the given number of rows and columns. The result contains the list
+ * of rectangles for each tile, which is empty for tiles without
+ * collision. Throws std::runtime_error on failure.
+ */
+vector<vector<bbox>> read_colrect_png(const string& collfile, int rows, int cols)
 {
-    FILE* infile = cmdline.collfile.empty() ? stdin : fopen(cmdline.collfile.c_str(), "rb");
-    if (!infile) {
-        cerr << "Failed to open collision rectangle PNG file." << endl;
-        exit(1);
-    }
+    if (rows <= 0 || cols <= 0)
+        throw(runtime_error("Rows and/or columns specification required. Did you pass -d?"));
+
+    FILE* infile = collfile.empty() ? stdin : fopen(collfile.c_str(), "rb");
+    if (!infile)
+        throw(runtime_error("Failed to open collision rectangle PNG file '" + collfile + "'."));
 
     if (!check_if_png(infile)) {
-        cerr << "Collision rectangle PNG is not a PNG file." << endl;
+        if (infile != stdin)
+            fclose(infile);
+        throw(runtime_error("Collision rectangle PNG '" + collfile + "' is not a PNG file."));
+    }
+
+    vector<vector<bbox>> tiles;
+    try {
+        tiles = extract_bboxes(infile, rows, cols);
+    }
+    catch (...) {
+        if (infile != stdin)
+            fclose(infile);
+        throw;
+    }
+
+    if (infile != stdin)
         fclose(infile);
-        exit(1);
+
+    return tiles;
+}
+
+/**
+ * Generates the metadata XML file `xmlfile' (standard output if
+ * empty) from the collision rectangle PNG `collfile' (standard
+ * input if empty). This function does not depend on the global
+ * `cmdline' and can thus be used from multiple threads at once.
+ * Throws std::runtime_error on failure.
+ */
+void write_meta_xml(const string& collfile, int rows, int cols, const string& xmlfile)
+{
+    vector<vector<bbox>> tiles = read_colrect_png(collfile, rows, cols);
+
+    if (all_of(tiles.begin(), tiles.end(), [](const vector<bbox>& boxes){ return boxes.empty(); }))
+        cerr << "Warning: No collision rectangles found" << endl;
+
+    // Output goes to real file if passed, otherwise standard output.
+    ofstream outfilefile;
+    if (!xmlfile.empty()) {
+        outfilefile.open(xmlfile);
+        if (!outfilefile)
+            throw(runtime_error("Failed to open file '" + xmlfile + "' for writing."));
     }
+    ostream& outfile = xmlfile.empty() ? cout : outfilefile;
 
-    output_xml(infile);
-    fclose(infile);
+    output_xml(tiles, rows, cols, outfile);
+}
+
+void generate_meta_xml()
+{
+    write_meta_xml(cmdline.collfile, cmdline.vtiles, cmdline.htiles, cmdline.xmlfile);
 }
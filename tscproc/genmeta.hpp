@@ -17,7 +17,12 @@
 
 #ifndef TSCPROC_GENMETA_HPP
 #define TSCPROC_GENMETA_HPP
+#include <string>
+#include <vector>
+#include "util.hpp"
 
 void generate_meta_xml();
+void write_meta_xml(const std::string& collfile, int rows, int cols, const std::string& xmlfile);
+std::vector<std::vector<bbox>> read_colrect_png(const std::string& collfile, int rows, int cols);
 
 #endif /* TSCPROC_GENMETA_HPP */
@@ -16,27 +16,50 @@
  */
 
 #include "commandline.hpp"
+#include "batch.hpp"
+#include "genbin.hpp"
 #include "genmeta.hpp"
 #include "genpng.hpp"
 #include <iostream>
+#include <stdexcept>
+#include <xercesc/util/PlatformUtils.hpp>
 
 using namespace std;
+using namespace xercesc;
 
 int main(int argc, char* argv[])
 {
     parse_commandline(argc, argv);
 
-    switch (cmdline.mode) {
-    case cmdmode::metadata:
-        generate_meta_xml();
-        break;
-    case cmdmode::png:
-        generate_colrect_png();
-        break;
-    default:
-        cerr << "Unknown mode." << endl;
-        return 1;
+    // Initialise Xerces-C once for all (possibly parallel) parses.
+    XMLPlatformUtils::Initialize();
+
+    int result = 0;
+    try {
+        switch (cmdline.mode) {
+        case cmdmode::metadata:
+            generate_meta_xml();
+            break;
+        case cmdmode::png:
+            generate_colrect_png();
+            break;
+        case cmdmode::binary:
+            generate_meta_bin();
+            break;
+        case cmdmode::batch:
+            result = process_tileset_directory(cmdline.batchdir, cmdline.jobs);
+            break;
+        default:
+            cerr << "Unknown mode." << endl;
+            result = 1;
+            break;
+        }
+    }
+    catch (const runtime_error& err) {
+        cerr << "Error: " << err.what() << endl;
+        result = 2;
     }
 
-    return 0;
+    XMLPlatformUtils::Terminate();
+    return result;
 }
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <cstdlib>
 #include <cstring>
+#include <stdexcept>
 #include <xercesc/util/PlatformUtils.hpp>
 #include <xercesc/sax2/DefaultHandler.hpp>
 #include <xercesc/sax2/SAX2XMLReader.hpp>
@@ -36,38 +37,93 @@ namespace {
     class TilesetHandler: public xercesc::DefaultHandler
     {
     public:
+        TilesetHandler()
+            : rows(0), cols(0)
+            {
+            }
+
         void startElement(const XMLCh* const,
                           const XMLCh* const xlocalname,
                           const XMLCh* const,
                           const Attributes& attrs)
             {
                 std::string localname(xstr_to_utf8(xlocalname));
-                if (localname == "colrect") {
+                m_chars.clear();
+
+                if (localname == "tile") {
+                    tiles.emplace_back();
+                }
+                else if (localname == "colrect") {
                     string x(xstr_to_utf8(attrs.getValue(utf8_to_xstr("x").get())));
                     string y(xstr_to_utf8(attrs.getValue(utf8_to_xstr("y").get())));
                     string w(xstr_to_utf8(attrs.getValue(utf8_to_xstr("width").get())));
                     string h(xstr_to_utf8(attrs.getValue(utf8_to_xstr("height").get())));
 
-                    boxes.push_back(move(bbox{atoi(x.c_str()), atoi(y.c_str()), atoi(w.c_str()), atoi(h.c_str())}));
+                    bbox box{atoi(x.c_str()), atoi(y.c_str()), atoi(w.c_str()), atoi(h.c_str())};
+
+                    // Older files mark tiles without collision with a -1 rectangle.
+                    if (box.x < 0 || box.y < 0)
+                        return;
+
+                    if (tiles.empty()) // <colrect> outside <tile>
+                        tiles.emplace_back();
+
+                    tiles.back().push_back(box);
                 }
             }
 
-        vector<bbox> boxes;
+        void endElement(const XMLCh* const,
+                        const XMLCh* const xlocalname,
+                        const XMLCh* const)
+            {
+                std::string localname(xstr_to_utf8(xlocalname));
+                if (localname == "rows")
+                    rows = atoi(m_chars.c_str());
+                else if (localname == "cols")
+                    cols = atoi(m_chars.c_str());
+            }
+
+        void characters(const XMLCh* const chars, const XMLSize_t)
+            {
+                m_chars += xstr_to_utf8(chars);
+            }
+
+        int rows;
+        int cols;
+        vector<vector<bbox>> tiles;
+    private:
+        string m_chars;
     };
 
 }
 
 /**
  * Parses the XML tileset metadata in the given file and returns
- * a list of collision rectangles found. If `path` is empty, reads
- * the XML from standard input instead.
+ * a list of all collision rectangles found, regardless of the tile
+ * they belong to. If `path` is empty, reads the XML from standard
+ * input instead.
  */
 vector<bbox> parse_tileset_metadata(const string& path)
 {
-    XMLPlatformUtils::Initialize();
+    vector<bbox> boxes;
+    for(const vector<bbox>& tile: parse_tileset_info(path).tiles)
+        boxes.insert(boxes.end(), tile.begin(), tile.end());
+
+    return boxes;
+}
 
-    // unique_ptr<SAX2XMLReader> p_parser(XMLReaderFactory::createXMLReader());
-    SAX2XMLReader* p_parser = XMLReaderFactory::createXMLReader();
+/**
+ * Like parse_tileset_metadata(), but returns the number of rows and
+ * columns of the tileset along with the collision rectangles of
+ * each tile.
+ *
+ * Each call uses its own parser, so this may be called from several
+ * threads at once. Xerces-C must have been initialised by main().
+ * Throws std::runtime_error if the XML cannot be parsed.
+ */
+tileset_info parse_tileset_info(const string& path)
+{
+    unique_ptr<SAX2XMLReader> p_parser(XMLReaderFactory::createXMLReader());
     p_parser->setFeature(XMLUni::fgSAX2CoreValidation, false);
 
     TilesetHandler handler;
@@ -84,18 +140,14 @@ vector<bbox> parse_tileset_metadata(const string& path)
         }
     }
     catch (const XMLException& err) {
-        cerr << "Error: " << xstr_to_utf8(err.getMessage()) << endl;
-        exit(2);
+        throw(runtime_error(path + ": " + xstr_to_utf8(err.getMessage())));
     }
     catch (const SAXParseException& err) {
-        cerr << "Error: " << xstr_to_utf8(err.getMessage()) << endl;
-        exit(2);
+        throw(runtime_error(path + ": " + xstr_to_utf8(err.getMessage())));
     }
     catch (...) {
-        cerr << "Unknown error on parsing the XML." << endl;
-        exit(2);
+        throw(runtime_error("Unknown error on parsing the XML."));
     }
 
-    XMLPlatformUtils::Terminate();
-    return handler.boxes;
+    return tileset_info{handler.rows, handler.cols, move(handler.tiles)};
 }
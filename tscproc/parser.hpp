@@ -21,6 +21,14 @@
 #include <vector>
 #include "util.hpp"
 
+/* Everything the tileset metadata XML file describes. */
+struct tileset_info {
+    int rows;
+    int cols;
+    std::vector<std::vector<bbox>> tiles; // Collision rectangles of each tile
+};
+
 std::vector<bbox> parse_tileset_metadata(const std::string& path);
+tileset_info parse_tileset_info(const std::string& path);
 
 #endif /* TSCPROC_PARSER_HPP */
@@ -17,6 +17,15 @@
 
 #include "util.hpp"
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <dirent.h>
+#include <sys/stat.h>
+#else
+#error Unsupported platform
+#endif
+
 bool check_if_png(FILE* fp)
 {
     unsigned char buf[PNG_MAGIC_BYTE_COUNT];
@@ -35,9 +44,81 @@ bool check_if_png(FILE* fp)
  * fully transparent black, but other programmes may as well just
  * do RGBA=(255|255|255|0) or however they see fit. Thus, the alpha
  * value is the only one one can realy on. */
-bool is_painted_pixel(png_byte* pix)
+bool is_painted_pixel(const png_byte* pix)
 {
     /* Third component is alpha value;
      * 0=transparent, 255=opaque as per PNG format spec. */
     return pix[3] > 0;
 }
+
+/* Calculates the 64-bit FNV-1a hash of the given file's contents.
+ * This is the checksum stored in the binary tileset metadata, so
+ * it must match the implementation in TSC's util.cpp. Returns false
+ * if the file cannot be read. */
+bool hash_file(const std::string& path, uint64_t& hash)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    unsigned char buf[4096];
+    size_t len = 0;
+
+    hash = 14695981039346656037ULL; // FNV offset basis
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        for (size_t i=0; i < len; i++) {
+            hash ^= buf[i];
+            hash *= 1099511628211ULL; // FNV prime
+        }
+    }
+
+    bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+
+bool file_exists(const std::string& path)
+{
+#if defined(_WIN32)
+    return GetFileAttributesA(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+#endif
+}
+
+/* Appends the names of all regular files in the directory `path' to
+ * `entries'. The names do not include the directory part and are in
+ * no particular order. Returns false if the directory cannot be read. */
+bool list_directory(const std::string& path, std::vector<std::string>& entries)
+{
+#if defined(_WIN32)
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((path + "\\*").c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    do {
+        if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            entries.push_back(data.cFileName);
+    } while (FindNextFileA(handle, &data));
+
+    FindClose(handle);
+    return true;
+#else
+    DIR* p_dir = opendir(path.c_str());
+    if (!p_dir)
+        return false;
+
+    struct dirent* p_entry = NULL;
+    while ((p_entry = readdir(p_dir))) {
+        struct stat info;
+        std::string fullpath = path + "/" + p_entry->d_name;
+        if (stat(fullpath.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+            entries.push_back(p_entry->d_name);
+    }
+
+    closedir(p_dir);
+    return true;
+#endif
+}
@@ -18,14 +18,19 @@
 #ifndef TSCPROC_UTIL_HPP
 #define TSCPROC_UTIL_HPP
 #include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
 #include <png.h>
 
 /* How many bytes libpng should check for whether we're dealing
  * with a PNG file. */
 #define PNG_MAGIC_BYTE_COUNT 8
 
-/* Bounding box. If a tile in a tileset has
- * no bounding box, the `x' and `y' members are set to -1. */
+/* Bounding box. A tile can have any number of these. Older
+ * metadata files mark a tile without a bounding box by setting
+ * the `x' and `y' members to -1; such boxes are skipped on
+ * parsing. */
 struct bbox {
     int x;
     int y;
@@ -34,6 +39,9 @@ struct bbox {
 };
 
 bool check_if_png(FILE* fp);
-bool is_painted_pixel(png_byte* pix);
+bool is_painted_pixel(const png_byte* pix);
+bool hash_file(const std::string& path, uint64_t& hash);
+bool file_exists(const std::string& path);
+bool list_directory(const std::string& path, std::vector<std::string>& entries);
 
 #endif /* TSCPROC_UTIL_HPP */